@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #if HAVE_CONFIG_H
@@ -129,6 +129,13 @@ static int _nanos6_check_disabled_variant(char const *optimization, char const *
 	if (disabled_symbol != NULL) {
 		fprintf(stderr, "Error: %s\n", common_error);
 		fprintf(stderr, "This installation has disabled the '%s' variant with '%s' dependencies and '%s' instrumentation.\n", optimization, dependencies, instrument);
+#if USE_CLUSTER
+		// The cluster support relies on the location, WriteID and namespace
+		// tracking that is only implemented by the regions dependencies
+		if (strcmp(dependencies, "discrete") == 0) {
+			fprintf(stderr, "Cluster installations only support regions dependencies. Please set version.dependencies=regions.\n");
+		}
+#endif
 		return -1;
 	}
 	return 0;
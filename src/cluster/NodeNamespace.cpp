@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 
@@ -23,7 +23,9 @@ NodeNamespace::NodeNamespace(SpawnFunction::function_t mainCallback, void *args)
 	_messageAction(nullptr),
 	_blockedTask(nullptr),
 	_callback(mainCallback, args),
-	_invocationInfo({"Spawned as a NodeNamespace"})
+	_invocationInfo({"Spawned as a NodeNamespace"}),
+	_taskInfo(),
+	_taskImplementationInfo()
 {
 	{
 		std::lock_guard<std::mutex> lk(m);
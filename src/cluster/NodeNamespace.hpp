@@ -1,14 +1,16 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 
 #ifndef NODENAMESPACE_H
 #define NODENAMESPACE_H
 
+#include <condition_variable>
 #include <deque>
+#include <mutex>
 #include <unistd.h>
 
 #include <ClusterShutdownCallback.hpp>
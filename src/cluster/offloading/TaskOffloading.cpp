@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include <map>
@@ -288,6 +288,11 @@ namespace TaskOffloading {
 			msg->getImplementations(numTaskImplementations);
 
 		taskInfo->implementations = taskImplementations;
+
+		// The tasktype data of the taskinfo belongs to the offloader node.
+		// The taskinfo is not registered in this node, so clear it
+		taskInfo->task_type_data = nullptr;
+
 		nanos6_task_invocation_info_t *taskInvocationInfo = msg->getTaskInvocationInfo();
 
 		size_t argsBlockSize;
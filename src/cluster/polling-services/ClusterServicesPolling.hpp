@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2018-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2018-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CLUSTER_SERVICES_POLLING_HPP
@@ -9,6 +9,7 @@
 
 #include "MessageHandler.hpp"
 #include "PendingQueue.hpp"
+#include "system/PollingAPI.hpp"
 
 #if HAVE_DLB
 #include "hybrid/HybridPolling.hpp"
@@ -16,6 +17,9 @@
 
 class ClusterServicesPolling {
 
+	//! Period of the hybrid polling service in microseconds
+	static constexpr uint64_t HYBRID_POLLING_PERIOD_US = 100000;
+
 	// Defined in ClusterManager.cpp
 	static std::atomic<size_t> _activeClusterPollingServices;
 	static std::atomic<bool> _pausedServices;
@@ -30,14 +34,14 @@ class ClusterServicesPolling {
 	}
 
 	template<typename T>
-	static void registerService(const std::string &name)
+	static void registerService(const std::string &name, const PollingAPI::ServiceAttributes &attributes)
 	{
 		const std::string label = "ClusterPolling_" + name;
 		_activeClusterPollingServices.fetch_add(1);
 
 		T::registerService();
 
-		nanos6_register_polling_service(label.c_str(), bodyClusterService<T>, nullptr);
+		PollingAPI::registerService(label.c_str(), bodyClusterService<T>, nullptr, attributes);
 	}
 
 	template<typename T>
@@ -65,14 +69,21 @@ public:
 
 		assert(MemoryAllocator::isInitialized());
 
+		// Incoming messages are latency critical, so they are checked before
+		// anything else. The hybrid policy rebalances the cores slowly, so
+		// it is polled much less often
 		if (!hybridOnly) {
 			assert(ClusterManager::inClusterMode());
-			registerService<ClusterPollingServices::MessageHandler<Message>>("MessageHandler");
-			registerService<ClusterPollingServices::PendingQueue<Message>>("PendingQueueMessage");
-			registerService<ClusterPollingServices::PendingQueue<DataTransfer>>("PendingQueueDataTransfer");
+			registerService<ClusterPollingServices::MessageHandler<Message>>("MessageHandler",
+				PollingAPI::ServiceAttributes(0, PollingAPI::HIGH_PRIORITY));
+			registerService<ClusterPollingServices::PendingQueue<Message>>("PendingQueueMessage",
+				PollingAPI::ServiceAttributes(0, PollingAPI::NORMAL_PRIORITY));
+			registerService<ClusterPollingServices::PendingQueue<DataTransfer>>("PendingQueueDataTransfer",
+				PollingAPI::ServiceAttributes(0, PollingAPI::NORMAL_PRIORITY));
 		}
 #if HAVE_DLB
-		registerService<ClusterPollingServices::HybridPolling>("HybridPolling");
+		registerService<ClusterPollingServices::HybridPolling>("HybridPolling",
+			PollingAPI::ServiceAttributes(HYBRID_POLLING_PERIOD_US, PollingAPI::LOW_PRIORITY));
 #endif
 	}
 
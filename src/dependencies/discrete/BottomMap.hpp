@@ -0,0 +1,297 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef BOTTOM_MAP_HPP
+#define BOTTOM_MAP_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "lowlevel/Padding.hpp"
+
+#include <MemoryAllocator.hpp>
+
+//! \brief Hash map from the addresses accessed by the children of a task to
+//! their last access
+//!
+//! The map is only modified by the thread that creates the children, so it
+//! needs no synchronization. It uses open addressing with linear probing over
+//! a single cache-line aligned array of slots, so a lookup usually touches a
+//! single cache line and inserting an address allocates nothing unless the
+//! table has to grow. The array is allocated on the first insertion, so tasks
+//! without children do not allocate it at all. It comes from MemoryAllocator
+//! instead of an ObjectAllocator, which only serves objects of a single type,
+//! since the array doubles its size every time the table grows. The entries
+//! must be trivially copyable and destructible
+template <typename EntryType>
+class BottomMap {
+public:
+	typedef std::pair<void *, EntryType> value_type;
+
+	class iterator {
+		value_type *_slot;
+		value_type *_end;
+
+		void skipEmpty()
+		{
+			while (_slot != _end && _slot->first == nullptr) {
+				++_slot;
+			}
+		}
+
+	public:
+		iterator() :
+			_slot(nullptr),
+			_end(nullptr)
+		{
+		}
+
+		iterator(value_type *slot, value_type *end) :
+			_slot(slot),
+			_end(end)
+		{
+			skipEmpty();
+		}
+
+		value_type &operator*() const
+		{
+			return *_slot;
+		}
+
+		value_type *operator->() const
+		{
+			return _slot;
+		}
+
+		iterator &operator++()
+		{
+			++_slot;
+			skipEmpty();
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			iterator result = *this;
+			++(*this);
+			return result;
+		}
+
+		bool operator==(iterator const &other) const
+		{
+			return _slot == other._slot;
+		}
+
+		bool operator!=(iterator const &other) const
+		{
+			return _slot != other._slot;
+		}
+	};
+
+private:
+	static constexpr size_t INITIAL_CAPACITY = 16;
+
+	//! Slots in use, where a null key marks a free slot
+	value_type *_slots;
+
+	//! Number of slots, which is always a power of two
+	size_t _capacity;
+
+	//! Number of slots in use
+	size_t _size;
+
+	//! Number of bits of the hash used to pick the first slot
+	int _hashBits;
+
+	//! \brief Fibonacci hashing, which spreads the aligned addresses of
+	//! consecutive objects through the whole table
+	inline size_t getFirstSlot(void *address) const
+	{
+		return (size_t) (((uint64_t) (uintptr_t) address * 11400714819323198485ULL) >> (64 - _hashBits));
+	}
+
+	inline value_type *findSlot(void *address) const
+	{
+		assert(address != nullptr);
+		assert(_slots != nullptr);
+
+		const size_t mask = _capacity - 1;
+		size_t index = getFirstSlot(address);
+		while (_slots[index].first != address && _slots[index].first != nullptr) {
+			index = (index + 1) & mask;
+		}
+		return &_slots[index];
+	}
+
+	inline void allocateSlots(size_t capacity)
+	{
+		assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+		_slots = (value_type *) MemoryAllocator::alloc(capacity * sizeof(value_type));
+		assert(_slots != nullptr);
+		for (size_t i = 0; i < capacity; ++i) {
+			_slots[i].first = nullptr;
+		}
+
+		_capacity = capacity;
+		_hashBits = __builtin_ctzl(capacity);
+	}
+
+	//! \brief Move all the entries to a table with twice the slots
+	void grow()
+	{
+		value_type *oldSlots = _slots;
+		const size_t oldCapacity = _capacity;
+
+		allocateSlots(oldCapacity * 2);
+		for (size_t i = 0; i < oldCapacity; ++i) {
+			if (oldSlots[i].first != nullptr) {
+				value_type *slot = findSlot(oldSlots[i].first);
+				assert(slot->first == nullptr);
+				new (slot) value_type(oldSlots[i]);
+			}
+		}
+
+		MemoryAllocator::free(oldSlots, oldCapacity * sizeof(value_type));
+	}
+
+public:
+	BottomMap() :
+		_slots(nullptr),
+		_capacity(0),
+		_size(0),
+		_hashBits(0)
+	{
+	}
+
+	~BottomMap()
+	{
+		// The entries are trivially destructible
+		if (_slots != nullptr) {
+			MemoryAllocator::free(_slots, _capacity * sizeof(value_type));
+		}
+	}
+
+	BottomMap(BottomMap const &other) = delete;
+	BottomMap &operator=(BottomMap const &other) = delete;
+
+	inline size_t size() const
+	{
+		return _size;
+	}
+
+	inline bool empty() const
+	{
+		return (_size == 0);
+	}
+
+	inline iterator begin() const
+	{
+		return iterator(_slots, _slots + _capacity);
+	}
+
+	inline iterator end() const
+	{
+		return iterator(_slots + _capacity, _slots + _capacity);
+	}
+
+	inline iterator find(void *address) const
+	{
+		if (_size == 0) {
+			return end();
+		}
+
+		value_type *slot = findSlot(address);
+		if (slot->first == nullptr) {
+			return end();
+		}
+		return iterator(slot, _slots + _capacity);
+	}
+
+	//! \brief Insert the entry of an address if the address is not in the map yet
+	//!
+	//! \param[in] address The address, which cannot be null
+	//! \param[in] args The arguments to construct the entry
+	//!
+	//! \returns An iterator to the entry of the address and whether it has
+	//! been inserted
+	template <typename... ARGS>
+	std::pair<iterator, bool> emplace(void *address, ARGS &&... args)
+	{
+		// Keep the load factor under 0.75 so that probe sequences stay short
+		if (_slots == nullptr) {
+			allocateSlots(INITIAL_CAPACITY);
+		} else if ((_size + 1) * 4 > _capacity * 3) {
+			grow();
+		}
+
+		value_type *slot = findSlot(address);
+		if (slot->first != nullptr) {
+			return std::make_pair(iterator(slot, _slots + _capacity), false);
+		}
+
+		new (slot) value_type(address, EntryType(std::forward<ARGS>(args)...));
+		_size++;
+
+		return std::make_pair(iterator(slot, _slots + _capacity), true);
+	}
+
+	//! \brief Remove the entry of an address if it is in the map
+	//!
+	//! The entries that follow it in its probe sequence are shifted back, so
+	//! the map does not need tombstones and lookups stay short
+	//!
+	//! \returns The number of removed entries
+	size_t erase(void *address)
+	{
+		if (_size == 0) {
+			return 0;
+		}
+
+		value_type *slot = findSlot(address);
+		if (slot->first == nullptr) {
+			return 0;
+		}
+
+		const size_t mask = _capacity - 1;
+		size_t hole = slot - _slots;
+		size_t index = hole;
+		while (true) {
+			index = (index + 1) & mask;
+			if (_slots[index].first == nullptr) {
+				break;
+			}
+
+			// The entry can fill the hole if the hole is not before its first
+			// slot in the probe sequence
+			const size_t firstSlot = getFirstSlot(_slots[index].first);
+			if (((index - firstSlot) & mask) >= ((index - hole) & mask)) {
+				new (&_slots[hole]) value_type(_slots[index]);
+				hole = index;
+			}
+		}
+
+		_slots[hole].first = nullptr;
+		_size--;
+
+		return 1;
+	}
+
+	//! \brief Remove all the entries, keeping the slots for later insertions
+	void clear()
+	{
+		for (size_t i = 0; i < _capacity; ++i) {
+			_slots[i].first = nullptr;
+		}
+		_size = 0;
+	}
+};
+
+
+#endif // BOTTOM_MAP_HPP
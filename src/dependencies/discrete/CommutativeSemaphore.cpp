@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "CommutativeSemaphore.hpp"
@@ -10,56 +10,105 @@
 #include "TaskDataAccesses.hpp"
 #include "tasks/Task.hpp"
 
-#include <mutex>
+#include <algorithm>
 
-CommutativeSemaphore::lock_t CommutativeSemaphore::_lock;
-CommutativeSemaphore::waiting_tasks_t CommutativeSemaphore::_waitingTasks;
-CommutativeSemaphore::commutative_mask_t CommutativeSemaphore::_mask;
+Padded<CommutativeSemaphore::Shard> CommutativeSemaphore::_shards[num_shards];
+std::atomic<uint64_t> CommutativeSemaphore::_nextOrder(0);
 
-bool CommutativeSemaphore::registerTask(Task *task)
+bool CommutativeSemaphore::acquireOrEnqueue(WaitingTask const &waitingTask)
 {
-	TaskDataAccesses &accessStruct = task->getDataAccesses();
-	const commutative_mask_t &mask = accessStruct._commutativeMask;
-	assert(mask.any());
+	TaskDataAccesses &accessStruct = waitingTask._task->getDataAccesses();
+	shard_words_t words;
+	getShardWords(accessStruct._commutativeMask, words);
+
+	lockShards(words);
+
+	for (int shard = 0; shard < num_shards; ++shard) {
+		if (words[shard] && (_shards[shard]._mask & words[shard])) {
+			// Wait in the first conflicting shard. Its lock is held, so the
+			// task that owns the conflicting bits will find it when releasing them
+			waiting_tasks_t &waitingTasks = _shards[shard]._waitingTasks;
+			waiting_tasks_t::iterator it = waitingTasks.end();
+			while (it != waitingTasks.begin() && (it - 1)->_order > waitingTask._order) {
+				--it;
+			}
+			waitingTasks.insert(it, waitingTask);
 
-	std::lock_guard<lock_t> guard(_lock);
-	if (maskIsCompatible(mask)) {
-		maskRegister(mask);
-		return true;
+			unlockShards(words);
+			return false;
+		}
+	}
+
+	for (int shard = 0; shard < num_shards; ++shard) {
+		if (words[shard]) {
+			_shards[shard]._mask |= words[shard];
+		}
 	}
 
-	_waitingTasks.emplace_back(std::forward<Task *>(task));
-	return false;
+	unlockShards(words);
+	return true;
+}
+
+bool CommutativeSemaphore::registerTask(Task *task)
+{
+	assert(task->getDataAccesses()._commutativeMask.any());
+
+	WaitingTask waitingTask = { _nextOrder.fetch_add(1, std::memory_order_relaxed), task };
+	return acquireOrEnqueue(waitingTask);
 }
 
 void CommutativeSemaphore::releaseTask(Task *task, CPUDependencyData &hpDependencyData)
 {
 	TaskDataAccesses &accessStruct = task->getDataAccesses();
-	const commutative_mask_t &mask = accessStruct._commutativeMask;
-	assert(mask.any());
-	commutative_mask_t released;
-
-	std::lock_guard<lock_t> guard(_lock);
-	maskRelease(mask);
-
-	waiting_tasks_t::iterator it = _waitingTasks.begin();
-
-	while (it != _waitingTasks.end()) {
-		Task *candidate = *it;
-		TaskDataAccesses &candidateStruct = candidate->getDataAccesses();
-		const commutative_mask_t &candidateMask = candidateStruct._commutativeMask;
-
-		if (maskIsCompatible(candidateMask)) {
-			maskRegister(candidateMask);
-			hpDependencyData._satisfiedCommutativeOriginators.push_back(candidate);
-			it = _waitingTasks.erase(it);
-
-			// Keep track and cut off if we won't be releasing anything else.
-			released |= (mask & candidateMask);
-			if (released == mask)
-				break;
-		} else {
-			++it;
+	assert(accessStruct._commutativeMask.any());
+
+	shard_words_t words;
+	getShardWords(accessStruct._commutativeMask, words);
+
+	// Release our bits and take the waiting tasks that were blocked by any of
+	// them. The candidates are retried once all the locks have been dropped,
+	// since they may need shards that precede the ones we hold
+	Container::vector<WaitingTask> candidates;
+
+	lockShards(words);
+
+	for (int shard = 0; shard < num_shards; ++shard) {
+		if (!words[shard]) {
+			continue;
+		}
+
+		_shards[shard]._mask &= ~words[shard];
+
+		waiting_tasks_t &waitingTasks = _shards[shard]._waitingTasks;
+		waiting_tasks_t::iterator it = waitingTasks.begin();
+		while (it != waitingTasks.end()) {
+			shard_words_t candidateWords;
+			getShardWords(it->_task->getDataAccesses()._commutativeMask, candidateWords);
+
+			if (candidateWords[shard] & words[shard]) {
+				candidates.push_back(*it);
+				it = waitingTasks.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	unlockShards(words);
+
+	if (candidates.empty()) {
+		return;
+	}
+
+	// Retry the candidates from the oldest to the newest one
+	std::sort(candidates.begin(), candidates.end(),
+		[](WaitingTask const &a, WaitingTask const &b) {
+			return a._order < b._order;
+		});
+
+	for (WaitingTask const &candidate : candidates) {
+		if (acquireOrEnqueue(candidate)) {
+			hpDependencyData._satisfiedCommutativeOriginators.push_back(candidate._task);
 		}
 	}
-}
\ No newline at end of file
+}
@@ -1,24 +1,40 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef COMMUTATIVE_SEMAPHORE_HPP
 #define COMMUTATIVE_SEMAPHORE_HPP
 
+#include <array>
+#include <atomic>
 #include <bitset>
 #include <cstdint>
 
 #include "lowlevel/PaddedTicketSpinLock.hpp"
+#include "lowlevel/Padding.hpp"
 #include "support/Containers.hpp"
 
 class Task;
 class ComputePlace;
 struct CPUDependencyData;
 
+//! \brief Arbiter of the commutative accesses of the ready tasks
+//!
+//! Each task has a mask with one bit set per hashed commutative address, and
+//! it can only run if its mask does not overlap with the masks of the running
+//! tasks. The mask is split into shards of 64 bits, each with its own lock
+//! and queue of waiting tasks, so that tasks with commutative accesses on
+//! unrelated addresses do not contend on a single lock. A task acquires all
+//! the bits of its mask or none of them by taking the locks of the shards
+//! it uses in increasing order
 class CommutativeSemaphore {
 	static constexpr int commutative_mask_bits = CACHELINE_SIZE * 8;
+	static constexpr int shard_bits = 64;
+	static constexpr int num_shards = commutative_mask_bits / shard_bits;
+
+	static_assert(commutative_mask_bits % shard_bits == 0, "Commutative mask cannot be split in shards");
 
 public:
 	typedef std::bitset<commutative_mask_bits> commutative_mask_t;
@@ -33,27 +49,65 @@ public:
 
 private:
 	typedef PaddedTicketSpinLock<> lock_t;
-	typedef Container::deque<Task *> waiting_tasks_t;
-
-	static lock_t _lock;
-	static commutative_mask_t _mask;
-	static waiting_tasks_t _waitingTasks;
-
-	static inline bool maskIsCompatible(const commutative_mask_t candidate)
+	typedef std::array<uint64_t, num_shards> shard_words_t;
+
+	//! A waiting task and its arrival order, which is kept when the task is
+	//! moved between shards so that the oldest tasks are woken up first
+	struct WaitingTask {
+		uint64_t _order;
+		Task *_task;
+	};
+
+	typedef Container::deque<WaitingTask> waiting_tasks_t;
+
+	struct Shard {
+		lock_t _lock;
+		uint64_t _mask;
+		waiting_tasks_t _waitingTasks;
+
+		Shard() :
+			_lock(),
+			_mask(0),
+			_waitingTasks()
+		{
+		}
+	};
+
+	static Padded<Shard> _shards[num_shards];
+	static std::atomic<uint64_t> _nextOrder;
+
+	static inline void getShardWords(const commutative_mask_t &mask, shard_words_t &words)
 	{
-		return ((_mask & candidate) == 0);
+		const commutative_mask_t wordMask(~0ULL);
+		for (int shard = 0; shard < num_shards; ++shard) {
+			words[shard] = ((mask >> (shard * shard_bits)) & wordMask).to_ullong();
+		}
 	}
 
-	static inline void maskRegister(const commutative_mask_t mask)
+	static inline void lockShards(const shard_words_t &words)
 	{
-		_mask |= mask;
+		for (int shard = 0; shard < num_shards; ++shard) {
+			if (words[shard]) {
+				_shards[shard]._lock.lock();
+			}
+		}
 	}
 
-	static inline void maskRelease(const commutative_mask_t mask)
+	static inline void unlockShards(const shard_words_t &words)
 	{
-		_mask &= ~mask;
+		for (int shard = num_shards - 1; shard >= 0; --shard) {
+			if (words[shard]) {
+				_shards[shard]._lock.unlock();
+			}
+		}
 	}
 
+	//! \brief Acquire all the bits of a task or enqueue it in a shard that
+	//! conflicts with it, keeping the queue sorted by arrival order
+	//!
+	//! \returns true if the task has acquired its bits
+	static bool acquireOrEnqueue(WaitingTask const &waitingTask);
+
 	//! Single-qword round of MurmurHash3
 	static inline unsigned long long addressHash(void *address)
 	{
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef DATA_ACCESS_HPP
@@ -45,18 +45,23 @@ private:
 	//! A bitmap of the "symbols" this access is related to
 	symbols_t _symbols;
 
-	//! Reduction-specific information of current access
-	ReductionInfo *_reductionInfo;
+	//! The reduction operator and index of a reduction access are only needed
+	//! to find or allocate its ReductionInfo, so they share the space with it
+	union {
+		//! Reduction-specific information of current access
+		ReductionInfo *_reductionInfo;
+
+		struct {
+			reduction_type_and_operator_index_t _reductionOperator;
+			reduction_index_t _reductionIndex;
+		} _reductionSpec;
+	};
 
 	//! Next task with an access matching this one
 	std::atomic<DataAccess *> _successor;
 	std::atomic<DataAccess *> _child;
 
 	//! 4-byte fields
-	//! Reduction information
-	reduction_type_and_operator_index_t _reductionOperator;
-	reduction_index_t _reductionIndex;
-
 	//! Atomic flags for Read / Write / Deletable / Finished
 	std::atomic<access_flags_t> _accessFlags;
 
@@ -136,6 +141,10 @@ public:
 		return _originator;
 	}
 
+	//! \brief Get the reduction info of the access
+	//!
+	//! Reduction accesses hold their reduction operator and index instead of
+	//! the reduction info until it is set when the access is inserted
 	inline ReductionInfo *getReductionInfo() const
 	{
 		return _reductionInfo;
@@ -187,22 +196,26 @@ public:
 
 	inline reduction_type_and_operator_index_t getReductionOperator() const
 	{
-		return _reductionOperator;
+		assert(_type == REDUCTION_ACCESS_TYPE);
+		return _reductionSpec._reductionOperator;
 	}
 
 	inline void setReductionOperator(reduction_type_and_operator_index_t reductionOperator)
 	{
-		_reductionOperator = reductionOperator;
+		assert(_type == REDUCTION_ACCESS_TYPE);
+		_reductionSpec._reductionOperator = reductionOperator;
 	}
 
 	inline reduction_index_t getReductionIndex() const
 	{
-		return _reductionIndex;
+		assert(_type == REDUCTION_ACCESS_TYPE);
+		return _reductionSpec._reductionIndex;
 	}
 
 	inline void setReductionIndex(reduction_index_t reductionIndex)
 	{
-		_reductionIndex = reductionIndex;
+		assert(_type == REDUCTION_ACCESS_TYPE);
+		_reductionSpec._reductionIndex = reductionIndex;
 	}
 
 	inline DataAccess *getChild() const
@@ -261,8 +274,8 @@ public:
 	}
 };
 
-// Assert that when using non-instrumented builds of nanos6 (where data_access_id_t is not an empty struct)
-// the DataAccess structure is packed to 64 bytes to prevent false sharing.
-static_assert(sizeof(Instrument::data_access_id_t) > 1 || sizeof(DataAccess) == 72, "DataAccess is not packed correctly");
+// Assert that when using non-instrumented builds of nanos6 (where data_access_id_t is an empty struct)
+// the DataAccess structure is packed to 64 bytes, so each access of a task takes a single cache line.
+static_assert(sizeof(Instrument::data_access_id_t) > 1 || sizeof(DataAccess) == 64, "DataAccess is not packed correctly");
 
 #endif // DATA_ACCESS_HPP
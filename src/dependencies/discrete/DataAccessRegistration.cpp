@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifdef HAVE_CONFIG_H
@@ -538,9 +538,7 @@ namespace DataAccessRegistration {
 
 			bottom_map_t &addresses = parentAccessStruct._subaccessBottomMap;
 			// Determine our predecessor safely, and maybe insert ourselves to the map.
-			std::pair<bottom_map_t::iterator, bool> result = addresses.emplace(std::piecewise_construct,
-				std::forward_as_tuple(address),
-				std::forward_as_tuple(access));
+			std::pair<bottom_map_t::iterator, bool> result = addresses.emplace(address, access);
 
 			itMap = result.first;
 
@@ -1,13 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef DEPENDENCY_SYSTEM_HPP
 #define DEPENDENCY_SYSTEM_HPP
 
 #include "CPUDependencyData.hpp"
+#include "executors/threads/CPUManager.hpp"
 #include "scheduling/SchedulerSupport.hpp"
 #include "system/RuntimeInfo.hpp"
 
@@ -21,6 +22,11 @@ public:
 		SatisfiedOriginatorList::_actualChunkSize = std::min(SatisfiedOriginatorList::getMaxChunkSize(), pow2CPUs * 2);
 		assert(SchedulerSupport::isPowOf2(SatisfiedOriginatorList::_actualChunkSize));
 	}
+
+	//! \brief Refresh the runtime information entries that change while running
+	static void updateRuntimeInfo()
+	{
+	}
 };
 
 #endif // DEPENDENCY_SYSTEM_HPP
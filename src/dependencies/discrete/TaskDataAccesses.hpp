@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASK_DATA_ACCESSES_HPP
@@ -12,6 +12,7 @@
 #include <functional>
 #include <mutex>
 
+#include "BottomMap.hpp"
 #include "BottomMapEntry.hpp"
 #include "CommutativeSemaphore.hpp"
 #include "TaskDataAccessesInfo.hpp"
@@ -24,7 +25,7 @@
 struct DataAccess;
 
 struct TaskDataAccesses {
-	typedef Container::unordered_map<void *, BottomMapEntry> bottom_map_t;
+	typedef BottomMap<BottomMapEntry> bottom_map_t;
 	typedef Container::unordered_map<void *, DataAccess> access_map_t;
 
 #ifndef NDEBUG
@@ -77,13 +78,11 @@ struct TaskDataAccesses {
 		_addressArray(taskAccessInfo.getAddressArrayLocation()),
 		_maxDeps(taskAccessInfo.getNumDeps()),
 		_currentIndex(0),
+		_commutativeMask(0),
 		_deletableCount(0),
-		_accessMap(nullptr)
 		_accessMap(nullptr),
 		_totalDataSize(0)
 	{
-		// Theoretically, 0.75 is a great load factor to prevent frequent rehashes
-		_subaccessBottomMap.max_load_factor(0.75);
 		if (_maxDeps > ACCESS_LINEAR_CUTOFF) {
 			_accessMap = MemoryAllocator::newObject<access_map_t>();
 			assert(_accessMap != nullptr);
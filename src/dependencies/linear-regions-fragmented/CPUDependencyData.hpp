@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CPU_DEPENDENCY_DATA_HPP
@@ -150,6 +150,9 @@ struct CPUDependencyData {
 	typedef Container::deque<DataAccess *> satisfied_taskwait_accesses_t;
 	typedef std::vector<TaskAndRegion> namespace_regions_to_remove_t;
 
+	//! Maximum number of satisfied originators passed to the scheduler at once
+	static const size_t _readyTasksBatchSize = 32;
+
 	//! Tasks whose accesses have been satisfied after ending a task
 	satisfied_originator_list_t _satisfiedOriginators;
 	satisfied_originator_list_t _satisfiedCommutativeOriginators;
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2019 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef DATA_ACCESS_HPP
@@ -982,6 +982,28 @@ public:
 					&& other->getValidNamespacePrevious() >= 0));
 	}
 
+	//! Function that returns if this fragment is equivalent to the previous one, so
+	//! that both can be coalesced into a single fragment without losing information.
+	//! This is stricter than canMergeWith: the fragments must also share the same
+	//! locations and namespace, and neither reductions nor fragments with a pending
+	//! data link step are coalesced, since they keep per-region state. Unlike
+	//! canMergeWith, the fragments must also have the same write ID.
+	//! \param[in] other A fragment before this.
+	inline bool canCoalesceWith(const DataAccess *other) const
+	{
+		return canMergeWith(other, true)
+			&& this->getWriteID() == other->getWriteID()
+			&& this->getObjectType() == other->getObjectType()
+			&& this->getType() != REDUCTION_ACCESS_TYPE
+			&& this->getDataLinkStep() == nullptr
+			&& this->getLocation() == other->getLocation()
+			&& this->getConcurrentInitialLocation() == other->getConcurrentInitialLocation()
+			&& this->getOutputLocation() == other->getOutputLocation()
+			&& this->getSymbols() == other->getSymbols()
+			&& this->getValidNamespaceSelf() == other->getValidNamespaceSelf()
+			&& this->getNamespacePredecessor() == other->getNamespacePredecessor();
+	}
+
 	friend std::ostream& operator<<(std::ostream& out, const DataAccess& access)
 	{
 		out << access._region << " id: " << access._writeID << " loc: " << *access._location;
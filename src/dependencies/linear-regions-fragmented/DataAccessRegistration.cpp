@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifdef HAVE_CONFIG_H
@@ -13,6 +13,7 @@
 #include <iostream>
 #include <mutex>
 #include <algorithm>
+#include <atomic>
 
 #include "BottomMapEntry.hpp"
 #include "CPUDependencyData.hpp"
@@ -632,6 +633,81 @@ namespace DataAccessRegistration {
 		}
 	}
 
+	//! The number of fragments that have been merged into a neighbour
+	static std::atomic<size_t> _numCoalescedFragments(0);
+
+	/*
+	 * Coalesce the fragments of a task that intersect a region, and their
+	 * immediate neighbours, once they have become equivalent. The pass only
+	 * visits the fragments that the caller has just traversed plus one at each
+	 * side, so its cost is bounded by the operation that triggered it instead
+	 * of by the total number of fragments of the task.
+	 */
+	static void coalesceFragments(
+		TaskDataAccesses &accessStructures,
+		DataAccessRegion const &region
+	) {
+		TaskDataAccesses::access_fragments_t &fragments = accessStructures._accessFragments;
+		if (fragments.size() <= 1) {
+			return;
+		}
+
+		Instrument::enterCoalesceFragments();
+		size_t coalescedFragments = 0;
+
+		// Start from the fragment right before the first one in the region
+		TaskDataAccesses::access_fragments_t::iterator it = fragments.lower_bound(region.getStartAddress());
+		if (it != fragments.begin()) {
+			it--;
+		}
+
+		DataAccess *lastFragment = nullptr;
+		while (it != fragments.end()) {
+			DataAccess *fragment = &(*it);
+			assert(fragment != nullptr);
+			assert(fragment->getObjectType() == fragment_type);
+			it++;
+
+			// The first fragment after the region is the last one to visit
+			const bool pastRegion =
+				(fragment->getAccessRegion().getStartAddress() >= region.getEndAddress());
+
+			if (fragment->canCoalesceWith(lastFragment)) {
+				DataAccessRegion newrel(
+					lastFragment->getAccessRegion().getStartAddress(),
+					fragment->getAccessRegion().getEndAddress()
+				);
+				lastFragment->setAccessRegion(newrel);
+
+				// Both fragments have the same status, so the one that is kept
+				// still blocks the removal of the task if this one did
+				DataAccessStatusEffects status(fragment);
+				if (!status._isRemovable) {
+					__attribute__((unused)) const int removalBlockers
+						= accessStructures._removalBlockers.fetch_sub(1) - 1;
+					assert(removalBlockers > 0);
+					fragment->markAsDiscounted();
+				}
+
+				fragments.erase(fragment);
+				ObjectAllocator<DataAccess>::deleteObject(fragment);
+				coalescedFragments++;
+			} else {
+				lastFragment = fragment;
+			}
+
+			if (pastRegion) {
+				break;
+			}
+		}
+
+		if (coalescedFragments > 0) {
+			_numCoalescedFragments.fetch_add(coalescedFragments, std::memory_order_relaxed);
+		}
+
+		Instrument::exitCoalesceFragments(coalescedFragments);
+	}
+
 	struct BottomMapUpdateOperation {
 		DataAccessRegion _region;
 		DataAccessType _parentAccessType;
@@ -1898,6 +1974,10 @@ namespace DataAccessRegistration {
 
 
 	//! Process all the originators that have become ready
+	//!
+	//! The originators are passed to the scheduler in batches of the same
+	//! device type, so that a release that satisfies many tasks enters the
+	//! scheduler once per batch instead of once per task
 	static inline void processSatisfiedOriginators(
 		/* INOUT */ CPUDependencyData &hpDependencyData,
 		ComputePlace *computePlace,
@@ -1905,15 +1985,18 @@ namespace DataAccessRegistration {
 	{
 		processSatisfiedCommutativeOriginators(hpDependencyData);
 
-		// NOTE: This is done without the lock held and may be slow since it can enter the scheduler
-		for (Task *satisfiedOriginator : hpDependencyData._satisfiedOriginators) {
-			assert(satisfiedOriginator != 0);
+		if (hpDependencyData._satisfiedOriginators.empty()) {
+			return;
+		}
+
+		const size_t batchSize = CPUDependencyData::_readyTasksBatchSize;
+		Task *batches[nanos6_device_type_num][batchSize];
+		size_t batchCounts[nanos6_device_type_num] = {};
 
+		auto flushBatch = [&](int deviceType) {
 			ComputePlace *computePlaceHint = nullptr;
-			if (computePlace != nullptr) {
-				if (computePlace->getType() == satisfiedOriginator->getDeviceType()) {
-					computePlaceHint = computePlace;
-				}
+			if (computePlace != nullptr && computePlace->getType() == deviceType) {
+				computePlaceHint = computePlace;
 			}
 
 			ReadyTaskHint schedulingHint = SIBLING_TASK_HINT;
@@ -1921,7 +2004,32 @@ namespace DataAccessRegistration {
 				schedulingHint = BUSY_COMPUTE_PLACE_TASK_HINT;
 			}
 
-			Scheduler::addReadyTask(satisfiedOriginator, computePlaceHint, schedulingHint);
+			Scheduler::addReadyTasks(
+				(nanos6_device_t) deviceType,
+				batches[deviceType],
+				batchCounts[deviceType],
+				computePlaceHint,
+				schedulingHint);
+			batchCounts[deviceType] = 0;
+		};
+
+		// NOTE: This is done without the lock held and may be slow since it can enter the scheduler
+		for (Task *satisfiedOriginator : hpDependencyData._satisfiedOriginators) {
+			assert(satisfiedOriginator != 0);
+
+			const int deviceType = satisfiedOriginator->getDeviceType();
+			assert(deviceType < nanos6_device_type_num);
+
+			batches[deviceType][batchCounts[deviceType]++] = satisfiedOriginator;
+			if (batchCounts[deviceType] == batchSize) {
+				flushBatch(deviceType);
+			}
+		}
+
+		for (int deviceType = 0; deviceType < nanos6_device_type_num; ++deviceType) {
+			if (batchCounts[deviceType] > 0) {
+				flushBatch(deviceType);
+			}
 		}
 
 		hpDependencyData._satisfiedOriginators.clear();
@@ -2282,6 +2390,9 @@ namespace DataAccessRegistration {
 
 					return true;
 				});
+
+			// The update may have made the fragments equivalent again
+			coalesceFragments(accessStructures, updateOperation._region);
 		} else {
 			// Update operation for taskwait Fragments
 			assert((updateOperation._target._objectType == taskwait_type) || (updateOperation._target._objectType == top_level_sink_type));
@@ -3640,6 +3751,7 @@ namespace DataAccessRegistration {
 					hpDependencyData);
 
 				/* Update bottom map */
+				const DataAccessRegion region = dataAccess->getAccessRegion();
 				replaceMatchingInBottomMapLinkAndPropagate(
 					DataAccessLink(task, access_type),
 					accessStructures,
@@ -3647,6 +3759,9 @@ namespace DataAccessRegistration {
 					parent, parentAccessStructures,
 					hpDependencyData);
 
+				/* Linking may have left equivalent fragments in the parent */
+				coalesceFragments(parentAccessStructures, region);
+
 				return true;
 			});
 
@@ -4539,6 +4654,53 @@ namespace DataAccessRegistration {
 		);
 	}
 
+	void registerTaskDataAccess(
+		Task *task, DataAccessType accessType, bool weak, DataAccessBox const &box, int symbolIndex)
+	{
+		assert(task != nullptr);
+		assert(!box.empty());
+
+		TaskDataAccesses &accessStructures = task->getDataAccesses();
+		assert(!accessStructures.hasBeenDeleted());
+
+		/*
+		 * The rows of a box never overlap each other, so if no previous
+		 * access of the task overlaps the bounding region of the box, each
+		 * row becomes a new access without fragmenting or upgrading anything.
+		 * Otherwise, register the rows one by one.
+		 */
+		if (box.getDimensions() == 1
+			|| accessType == AUTO_ACCESS_TYPE
+			|| accessStructures._accesses.contains(box.getBoundingRegion())
+		) {
+			box.processRows(
+				[&](DataAccessRegion const &row) -> bool {
+					registerTaskDataAccess(task, accessType, weak, row, symbolIndex,
+						no_reduction_type_and_operator, no_reduction_index);
+					return true;
+				}
+			);
+			return;
+		}
+
+		DataAccess::symbols_t symbol_list;
+		if (symbolIndex >= 0)
+			symbol_list.set(symbolIndex);
+
+		const int currentNodeIndex = ClusterManager::getCurrentClusterNode()->getIndex();
+		box.processRows(
+			[&](DataAccessRegion const &row) -> bool {
+				DataAccess *newAccess = createAccess(task, access_type, accessType, weak, row,
+					no_reduction_type_and_operator, no_reduction_index);
+				newAccess->addToSymbols(symbol_list);
+				newAccess->setValidNamespacePrevious(currentNodeIndex, OffloadedTaskIdManager::InvalidOffloadedTaskId);
+
+				accessStructures._accesses.insert(*newAccess);
+				return true;
+			}
+		);
+	}
+
 	/*
 	 * This function is called by submitTask to register a task and its
 	 * dependencies in the dependency system. The function starts by calling
@@ -6148,6 +6310,11 @@ namespace DataAccessRegistration {
 	{
 		return true;
 	}
+
+	size_t getNumCoalescedFragments()
+	{
+		return _numCoalescedFragments.load(std::memory_order_relaxed);
+	}
 }; // namespace DataAccessRegistration
 
 #pragma GCC visibility pop
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef DATA_ACCESS_REGISTRATION_HPP
@@ -10,6 +10,7 @@
 #include <functional>
 
 #include <api/nanos6/task-instantiation.h>
+#include <DataAccessBox.hpp>
 #include <DataAccessRegion.hpp>
 
 #include "CPUDependencyData.hpp"
@@ -42,6 +43,20 @@ namespace DataAccessRegistration {
 		OffloadedTaskIdManager::OffloadedTaskId namespacePredecessor = OffloadedTaskIdManager::InvalidOffloadedTaskId
 	);
 
+	//! \brief creates the task data accesses of the rows of a box, like registerTaskDataAccess does for each row
+	//!
+	//! \param[in,out] task the task that performs the access
+	//! \param[in] accessType the type of access
+	//! \param[in] weak true iff the access is weak
+	//! \param[in] box the box of data covered by the access
+	void registerTaskDataAccess(
+		Task *task,
+		DataAccessType accessType,
+		bool weak,
+		DataAccessBox const &box,
+		int symbolIndex
+	);
+
 	//! \brief Performs the task dependency registration procedure
 	//!
 	//! \param[in] task the Task whose dependencies need to be calculated
@@ -230,6 +245,10 @@ namespace DataAccessRegistration {
 	void accessInfo(Task *task, DataAccessRegion region, CPUDependencyData &hpDependencyData, bool noEagerSend, bool isReadOnly);
 
 	bool supportsDataTracking();
+
+	//! \brief Get the number of fragments that have been merged into a
+	//! neighbour since the runtime started
+	size_t getNumCoalescedFragments();
 } // namespace DataAccessRegistration
 
 
@@ -1,12 +1,13 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef DEPENDENCY_SYSTEM_HPP
 #define DEPENDENCY_SYSTEM_HPP
 
+#include "DataAccessRegistration.hpp"
 #include "system/RuntimeInfo.hpp"
 
 
@@ -15,6 +16,13 @@ public:
 	static void initialize()
 	{
 		RuntimeInfo::addEntry("dependency_implementation", "Dependency Implementation", "regions (linear-regions-fragmented)");
+		RuntimeInfo::addEntry("coalesced_fragments", "Coalesced Fragments", 0L);
+	}
+
+	//! \brief Refresh the runtime information entries that change while running
+	static void updateRuntimeInfo()
+	{
+		RuntimeInfo::updateEntry("coalesced_fragments", DataAccessRegistration::getNumCoalescedFragments());
 	}
 };
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MULTIDIMENSIONAL_API_HPP
@@ -10,6 +10,7 @@
 
 #include <nanos6/multidimensional-dependencies.h>
 
+#include "DataAccessBox.hpp"
 #include "Dependencies.hpp"
 
 #include "../DataAccessType.hpp"
@@ -25,6 +26,16 @@
 #define _UU_ __attribute__((unused))
 
 
+//! \brief Register a task access over a box of a multidimensional array
+//!
+//! \param[in] handler the handler received in register_depinfo
+//! \param[in] accessType the type of access
+//! \param[in] weak true iff the access is weak
+//! \param[in] box the accessed box
+//! \param[in] symbolIndex the index of the symbol of the access
+void register_box_access(void *handler, DataAccessType accessType, bool weak, DataAccessBox const &box, int symbolIndex);
+
+
 template <DataAccessType ACCESS_TYPE, bool WEAK>
 _AI_ void register_data_access_base(
 	void *handler, int symbolIndex, char const *regionText, void *baseAddress,
@@ -131,15 +142,6 @@ _AI_ void register_data_access_base<COMMUTATIVE_ACCESS_TYPE, false>(
 	nanos6_register_commutative_depinfo(handler, (void *) start, currentDimEnd - currentDimStart, symbolIndex);
 }
 
-template <DataAccessType ACCESS_TYPE, bool WEAK, typename... TS>
-static _AI_ void register_data_access_skip_next(
-	void *handler, int symbolIndex, char const *regionText, void *baseAddress,
-	long currentDimSize, long currentDimStart, long currentDimEnd,
-	long nextDimSize, long nextDimStart, long nextDimEnd,
-	TS... otherDimensions
-);
-
-
 template <DataAccessType ACCESS_TYPE, bool WEAK>
 static _AI_ void register_data_access(
 	void *handler, int symbolIndex, char const *regionText, void *baseAddress,
@@ -150,38 +152,14 @@ static _AI_ void register_data_access(
 
 template <DataAccessType ACCESS_TYPE, bool WEAK, typename... TS>
 static _AI_ void register_data_access(
-	void *handler, int symbolIndex, char const *regionText, void *baseAddress,
+	void *handler, int symbolIndex, _UU_ char const *regionText, void *baseAddress,
 	long currentDimSize, long currentDimStart, long currentDimEnd,
 	TS... otherDimensions
 ) {
-	if (currentDimensionIsContinuous(otherDimensions...)) {
-		register_data_access_skip_next<ACCESS_TYPE, WEAK>(handler, symbolIndex, regionText, baseAddress,
-			currentDimSize * getCurrentDimensionSize(otherDimensions...),
-			currentDimStart * getCurrentDimensionSize(otherDimensions...),
-			currentDimEnd * getCurrentDimensionSize(otherDimensions...),
-			otherDimensions...
-		);
-	} else {
-		size_t stride = getStride<>(otherDimensions...);
-		char *currentBaseAddress = (char *) baseAddress;
-		currentBaseAddress += currentDimStart * stride;
-		
-		for (long index = currentDimStart; index < currentDimEnd; index++) {
-			register_data_access<ACCESS_TYPE, WEAK>(handler, symbolIndex, regionText, currentBaseAddress, otherDimensions...);
-			currentBaseAddress += stride;
-		}
-	}
-}
-
-
-template <DataAccessType ACCESS_TYPE, bool WEAK, typename... TS>
-static _AI_ void register_data_access_skip_next(
-	void *handler, int symbolIndex, char const *regionText, void *baseAddress,
-	long currentDimSize, long currentDimStart, long currentDimEnd,
-	_UU_ long nextDimSize, _UU_ long nextDimStart, _UU_ long nextDimEnd,
-	TS... otherDimensions
-) {
-	register_data_access<ACCESS_TYPE, WEAK>(handler, symbolIndex, regionText, baseAddress, currentDimSize, currentDimStart, currentDimEnd, otherDimensions...);
+	// Register the access as a whole instead of one access per row, so that
+	// the rows are inserted without searching the accesses of the task again
+	DataAccessBox box(baseAddress, currentDimSize, currentDimStart, currentDimEnd, otherDimensions...);
+	register_box_access(handler, ACCESS_TYPE, WEAK, box, symbolIndex);
 }
 
 
@@ -252,7 +230,7 @@ static _AI_ void register_reduction_access(
 		currentBaseAddress += currentDimStart * stride;
 		
 		for (long index = currentDimStart; index < currentDimEnd; index++) {
-			register_reduction_access<WEAK>(reduction_operation, reduction_index, handler, symbolIndex, regionText, baseAddress, otherDimensions...);
+			register_reduction_access<WEAK>(reduction_operation, reduction_index, handler, symbolIndex, regionText, currentBaseAddress, otherDimensions...);
 			currentBaseAddress += stride;
 		}
 	}
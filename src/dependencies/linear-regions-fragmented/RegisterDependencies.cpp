@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include <cassert>
@@ -9,6 +9,7 @@
 #include <nanos6.h>
 
 #include "DataAccessRegistration.hpp"
+#include "MultidimensionalAPI.hpp"
 #include "ReductionSpecific.hpp"
 #include "../DataAccessType.hpp"
 #include "executors/threads/WorkerThread.hpp"
@@ -46,6 +47,31 @@ void register_access(void *handler, void *start, size_t length, int symbolIndex,
 }
 
 
+void register_box_access(void *handler, DataAccessType accessType, bool weakAccess, DataAccessBox const &box, int symbolIndex)
+{
+	assert(handler != 0);
+	Task *task = (Task *) handler;
+
+	if (weakAccess && task->isTaskfor()) {
+		std::cerr << "Warning: task loop cannot have weak dependencies. Changing them to strong dependencies." << std::endl;
+	}
+
+	bool weak = (weakAccess && !task->isFinal() && !task->isTaskfor()) || task->isTaskloopSource();
+	box.processRows(
+		[&](DataAccessRegion const &row) -> bool {
+			Instrument::registerTaskAccess(task->getInstrumentationTaskId(), accessType, weak, row.getStartAddress(), row.getSize());
+			return true;
+		}
+	);
+
+	if (box.empty() || box.getStartAddress() == nullptr) {
+		return;
+	}
+
+	DataAccessRegistration::registerTaskDataAccess(task, accessType, weak, box, symbolIndex);
+}
+
+
 void nanos6_register_read_depinfo(void *handler, void *start, size_t length, int symbolIndex)
 {
 	register_access<READ_ACCESS_TYPE, false>(handler, start, length, symbolIndex);
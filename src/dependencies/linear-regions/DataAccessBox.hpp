@@ -0,0 +1,241 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef DATA_ACCESS_BOX_HPP
+#define DATA_ACCESS_BOX_HPP
+
+
+#include <cassert>
+#include <cstddef>
+#include <ostream>
+
+#include "DataAccessRegion.hpp"
+
+
+//! \brief A hyper-rectangular region of a multidimensional array
+//!
+//! The box is described by the address of the array and, for each dimension,
+//! the distance in bytes between two consecutive elements and the range of
+//! accessed elements. Dimensions are ordered from the outermost to the
+//! innermost, and the innermost dimension is always a contiguous row of bytes.
+//!
+//! Boxes are kept in canonical form, in which the dimensions that are accessed
+//! completely are merged with their outer dimension. Therefore, a box of one
+//! dimension is a DataAccessRegion, and a box of N dimensions has as many rows
+//! as the product of the counts of its N-1 outer dimensions
+class DataAccessBox {
+public:
+	static constexpr int MAX_DIMENSIONS = 8;
+
+private:
+	//! The address of the array
+	char *_arrayAddress;
+
+	//! The number of dimensions of the box
+	int _dimensions;
+
+	//! The bytes between two consecutive elements of each dimension
+	size_t _stride[MAX_DIMENSIONS];
+
+	//! The first accessed element of each dimension
+	size_t _start[MAX_DIMENSIONS];
+
+	//! The number of accessed elements of each dimension
+	size_t _count[MAX_DIMENSIONS];
+
+	void addDimensions(size_t)
+	{
+	}
+
+	template <typename... TS>
+	void addDimensions(size_t stride, long dimSize, long dimStart, long dimEnd, TS... otherDimensions)
+	{
+		// The stride of this dimension is the size of all the inner dimensions
+		stride /= dimSize;
+
+		assert(_dimensions < MAX_DIMENSIONS);
+		assert(0 <= dimStart && dimStart <= dimEnd && dimEnd <= dimSize);
+		_stride[_dimensions] = stride;
+		_start[_dimensions] = dimStart;
+		_count[_dimensions] = dimEnd - dimStart;
+		_dimensions++;
+
+		addDimensions(stride, otherDimensions...);
+	}
+
+	template <typename... TS>
+	static size_t getArraySize()
+	{
+		return 1;
+	}
+
+	template <typename... TS>
+	static size_t getArraySize(long dimSize, long, long, TS... otherDimensions)
+	{
+		return dimSize * getArraySize<>(otherDimensions...);
+	}
+
+	//! \brief Merge the dimensions that are accessed completely with their
+	//! outer dimension
+	void canonicalize()
+	{
+		assert(_dimensions > 0);
+
+		for (int dim = _dimensions - 1; dim > 0; --dim) {
+			if (_count[dim] * _stride[dim] != _stride[dim - 1]) {
+				continue;
+			}
+
+			// The whole inner dimension is accessed, so its start is zero
+			assert(_start[dim] == 0);
+			_start[dim - 1] *= _count[dim];
+			_count[dim - 1] *= _count[dim];
+			_stride[dim - 1] = _stride[dim];
+
+			for (int inner = dim; inner < _dimensions - 1; ++inner) {
+				_stride[inner] = _stride[inner + 1];
+				_start[inner] = _start[inner + 1];
+				_count[inner] = _count[inner + 1];
+			}
+			_dimensions--;
+		}
+
+		assert(_stride[_dimensions - 1] == 1);
+	}
+
+public:
+	//! \brief Build a box from the arguments of the multidimensional API
+	//!
+	//! \param[in] baseAddress the address of the array
+	//! \param[in] dimSize, dimStart, dimEnd the size of each dimension of the
+	//! array and the accessed range, from the outermost to the innermost one,
+	//! where the innermost dimension is measured in bytes
+	template <typename... TS>
+	DataAccessBox(void *baseAddress, long dimSize, long dimStart, long dimEnd, TS... otherDimensions)
+		: _arrayAddress((char *) baseAddress), _dimensions(0)
+	{
+		addDimensions(
+			getArraySize(dimSize, dimStart, dimEnd, otherDimensions...),
+			dimSize, dimStart, dimEnd, otherDimensions...);
+		canonicalize();
+	}
+
+	DataAccessBox(DataAccessRegion const &region)
+		: _arrayAddress((char *) region.getStartAddress()), _dimensions(1)
+	{
+		_stride[0] = 1;
+		_start[0] = 0;
+		_count[0] = region.getSize();
+	}
+
+	bool empty() const
+	{
+		for (int dim = 0; dim < _dimensions; ++dim) {
+			if (_count[dim] == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int getDimensions() const
+	{
+		return _dimensions;
+	}
+
+	void *getStartAddress() const
+	{
+		char *start = _arrayAddress;
+		for (int dim = 0; dim < _dimensions; ++dim) {
+			start += _start[dim] * _stride[dim];
+		}
+		return start;
+	}
+
+	//! \brief Get the number of contiguous rows of the box
+	size_t getNumRows() const
+	{
+		size_t rows = 1;
+		for (int dim = 0; dim < _dimensions - 1; ++dim) {
+			rows *= _count[dim];
+		}
+		return rows;
+	}
+
+	//! \brief Get the bytes of each contiguous row of the box
+	size_t getRowSize() const
+	{
+		return _count[_dimensions - 1];
+	}
+
+	//! \brief Get the contiguous region that spans from the first to the last byte
+	DataAccessRegion getBoundingRegion() const
+	{
+		if (empty()) {
+			return DataAccessRegion();
+		}
+
+		size_t length = getRowSize();
+		for (int dim = 0; dim < _dimensions - 1; ++dim) {
+			length += (_count[dim] - 1) * _stride[dim];
+		}
+		return DataAccessRegion(getStartAddress(), length);
+	}
+
+	//! \brief Call a processor with each contiguous row of the box in
+	//! increasing address order
+	//!
+	//! \returns false if the processor returned false for any row
+	template <typename ProcessorType>
+	bool processRows(ProcessorType processor) const
+	{
+		if (empty()) {
+			return true;
+		}
+
+		const int rowDimension = _dimensions - 1;
+		const size_t rowSize = getRowSize();
+
+		size_t index[MAX_DIMENSIONS] = {};
+		char *rowStart = (char *) getStartAddress();
+		while (true) {
+			DataAccessRegion row(rowStart, rowSize);
+			if (!processor(row)) {
+				return false;
+			}
+
+			// Advance to the next row like an odometer over the outer dimensions
+			int dim = rowDimension - 1;
+			while (dim >= 0) {
+				index[dim]++;
+				rowStart += _stride[dim];
+				if (index[dim] < _count[dim]) {
+					break;
+				}
+
+				rowStart -= index[dim] * _stride[dim];
+				index[dim] = 0;
+				dim--;
+			}
+
+			if (dim < 0) {
+				return true;
+			}
+		}
+	}
+
+	friend inline std::ostream & operator<<(std::ostream &o, const DataAccessBox &box)
+	{
+		o << (void *) box._arrayAddress;
+		for (int dim = 0; dim < box._dimensions; ++dim) {
+			o << "[" << box._start[dim] << ":" << box._start[dim] + box._count[dim] << "]";
+		}
+		return o;
+	}
+};
+
+
+#endif // DATA_ACCESS_BOX_HPP
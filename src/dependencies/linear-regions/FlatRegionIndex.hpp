@@ -0,0 +1,216 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef FLAT_REGION_INDEX_HPP
+#define FLAT_REGION_INDEX_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "DataAccessRegion.hpp"
+
+
+//! \brief Sorted index of disjoint regions stored as a structure of arrays
+//!
+//! The start and end addresses of the regions are kept in two contiguous
+//! arrays, so a lookup bisects without branches until a few cache lines are
+//! left and then counts the regions that end before the address with vector
+//! comparisons. On x86-64, the AVX-512 or AVX2 version of the count is chosen
+//! at run time from the features of the CPU, whatever the compilation flags,
+//! and plain code that the compiler can vectorize is used otherwise. Inserting
+//! and erasing move the tail of the arrays, so the index suits maps that are
+//! looked up much more often than they are modified. The index does not own
+//! the contents and the processors must not modify it while it is traversed
+template <typename ContentType>
+class FlatRegionIndex {
+	//! Number of candidates below which the lookup stops bisecting and scans
+	static constexpr size_t SCAN_THRESHOLD = 64;
+
+	std::vector<uintptr_t> _starts;
+	std::vector<uintptr_t> _ends;
+	std::vector<ContentType *> _contents;
+
+	typedef size_t (*count_function_t)(uintptr_t const *values, size_t count, uintptr_t address);
+
+	//! \brief Choose the fastest count that the CPU supports
+	static count_function_t selectCountNotAbove()
+	{
+#if defined(__x86_64__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f")) {
+			return countNotAboveAVX512;
+		} else if (__builtin_cpu_supports("avx2")) {
+			return countNotAboveAVX2;
+		}
+#endif
+		return countNotAboveScalar;
+	}
+
+	//! \brief Count the elements of an array that are lower or equal than an address
+	static inline size_t countNotAbove(uintptr_t const *values, size_t count, uintptr_t address)
+	{
+		static const count_function_t countFunction = selectCountNotAbove();
+		return countFunction(values, count, address);
+	}
+
+	//! \brief Get the position of the first region that ends after an address
+	inline size_t lowerBound(uintptr_t address) const
+	{
+		uintptr_t const *ends = _ends.data();
+		size_t first = 0;
+		size_t count = _ends.size();
+
+		// The ends are sorted because the regions are disjoint
+		while (count > SCAN_THRESHOLD) {
+			const size_t half = count / 2;
+			first += (ends[first + half - 1] <= address) ? half : 0;
+			count -= half;
+		}
+
+		return first + countNotAbove(ends + first, count, address);
+	}
+
+public:
+	//! \brief Count the elements of an array that are lower or equal than an address without vector instructions
+	static size_t countNotAboveScalar(uintptr_t const *values, size_t count, uintptr_t address)
+	{
+		size_t result = 0;
+		for (size_t i = 0; i < count; ++i) {
+			result += (values[i] <= address);
+		}
+		return result;
+	}
+
+#if defined(__x86_64__)
+	//! \brief Count the elements of an array that are lower or equal than an address with AVX2
+	//!
+	//! Only call it if the CPU supports AVX2
+	__attribute__((target("avx2")))
+	static size_t countNotAboveAVX2(uintptr_t const *values, size_t count, uintptr_t address)
+	{
+		size_t result = 0;
+		size_t i = 0;
+
+		// AVX2 only compares signed integers, so flip the sign bits of both sides
+		const __m256i bias = _mm256_set1_epi64x((long long) (1ULL << 63));
+		const __m256i key = _mm256_xor_si256(_mm256_set1_epi64x((long long) address), bias);
+		for (; i + 4 <= count; i += 4) {
+			const __m256i chunk = _mm256_xor_si256(
+				_mm256_loadu_si256((__m256i const *) (values + i)), bias);
+			const __m256i above = _mm256_cmpgt_epi64(chunk, key);
+			result += 4 - __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(above)));
+		}
+
+		return result + countNotAboveScalar(values + i, count - i, address);
+	}
+
+	//! \brief Count the elements of an array that are lower or equal than an address with AVX-512
+	//!
+	//! Only call it if the CPU supports AVX-512F
+	__attribute__((target("avx512f")))
+	static size_t countNotAboveAVX512(uintptr_t const *values, size_t count, uintptr_t address)
+	{
+		size_t result = 0;
+		size_t i = 0;
+
+		const __m512i key = _mm512_set1_epi64((long long) address);
+		for (; i + 8 <= count; i += 8) {
+			const __m512i chunk = _mm512_loadu_si512((void const *) (values + i));
+			result += __builtin_popcount(_mm512_cmple_epu64_mask(chunk, key));
+		}
+
+		return result + countNotAboveScalar(values + i, count - i, address);
+	}
+#endif
+
+	FlatRegionIndex() :
+		_starts(),
+		_ends(),
+		_contents()
+	{
+	}
+
+	inline bool empty() const
+	{
+		return _contents.empty();
+	}
+
+	inline size_t size() const
+	{
+		return _contents.size();
+	}
+
+	//! \brief Add an element whose region does not intersect any other
+	void insert(ContentType *content)
+	{
+		assert(content != nullptr);
+
+		DataAccessRegion const &region = content->getAccessRegion();
+		const uintptr_t start = (uintptr_t) region.getStartAddress();
+		const uintptr_t end = (uintptr_t) region.getEndAddress();
+
+		const size_t position = lowerBound(start);
+		assert(position == _starts.size() || _starts[position] >= end);
+
+		_starts.insert(_starts.begin() + position, start);
+		_ends.insert(_ends.begin() + position, end);
+		_contents.insert(_contents.begin() + position, content);
+	}
+
+	//! \brief Remove an element, which must have the same region as when it was inserted
+	void erase(ContentType *content)
+	{
+		assert(content != nullptr);
+
+		const size_t position = lowerBound((uintptr_t) content->getAccessRegion().getStartAddress());
+		assert(position < _contents.size());
+		assert(_contents[position] == content);
+
+		_starts.erase(_starts.begin() + position);
+		_ends.erase(_ends.begin() + position);
+		_contents.erase(_contents.begin() + position);
+	}
+
+	void clear()
+	{
+		_starts.clear();
+		_ends.clear();
+		_contents.clear();
+	}
+
+	//! \brief Pass all elements that intersect a given region through a lambda
+	//!
+	//! \param[in] region the region to explore
+	//! \param[in] processor a lambda that receives a pointer to each element intersecting the region in increasing address order and that returns a boolean, that is false to stop the traversal
+	//!
+	//! \returns false if the traversal was stopped before finishing
+	template <typename ProcessorType>
+	bool processIntersecting(DataAccessRegion const &region, ProcessorType processor) const
+	{
+		if (region.getSize() == 0) {
+			return true;
+		}
+
+		const uintptr_t end = (uintptr_t) region.getEndAddress();
+		const size_t size = _contents.size();
+
+		for (size_t i = lowerBound((uintptr_t) region.getStartAddress()); i < size && _starts[i] < end; ++i) {
+			if (!processor(_contents[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+
+#endif // FLAT_REGION_INDEX_HPP
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CPU_HPP
@@ -82,6 +82,10 @@ private:
 	//! The hardware counter structures of this CPU
 	CPUHardwareCounters _hardwareCounters;
 
+	//! The number of tasks that the threads of this CPU obtained from the
+	//! scheduler. Only the thread running on the CPU accesses it
+	size_t _executedTasks;
+
 public:
 
 	//! \brief Constructor for regular CPUs
@@ -104,7 +108,8 @@ public:
 		_activationStatus(uninitialized_status),
 		_systemCPUId((size_t) -1),
 		_NUMANodeId(0),
-		_hardwareCounters()
+		_hardwareCounters(),
+		_executedTasks(0)
 	{
 	}
 
@@ -192,6 +197,16 @@ public:
 		return _hardwareCounters;
 	}
 
+	inline void increaseExecutedTasks()
+	{
+		++_executedTasks;
+	}
+
+	inline size_t getExecutedTasks() const
+	{
+		return _executedTasks;
+	}
+
 };
 
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASK_FINALIZATION_IMPLEMENTATION_HPP
@@ -16,6 +16,7 @@
 #include "scheduling/Scheduler.hpp"
 #include "system/TrackingPoints.hpp"
 #include "tasks/StreamManager.hpp"
+#include "tasks/TaskAllocationCache.hpp"
 #include "tasks/Taskfor.hpp"
 #include "tasks/Taskloop.hpp"
 
@@ -175,6 +176,7 @@ void TaskFinalization::disposeTask(Task *task)
 			disposableBlockSize += taskAccesses.getAdditionalMemorySize();
 			disposableBlockSize += TaskHardwareCounters::getAllocationSize();
 			disposableBlockSize += Monitoring::getAllocationSize();
+			disposableBlockSize += sizeof(nanos6_task_constraints_t);
 
 			Instrument::taskIsBeingDeleted(task->getInstrumentationTaskId());
 
@@ -184,6 +186,9 @@ void TaskFinalization::disposeTask(Task *task)
 				taskInfo->destroy_args_block(task->getArgsBlock());
 			}
 
+			// Must match the tasktype data used in AddTask::createTask
+			TasktypeData *tasktypeData = task->getTasktypeData();
+
 			StreamFunctionCallback *spawnCallback = task->getParentSpawnCallback();
 			if (spawnCallback != nullptr) {
 				StreamExecutor *executor = (StreamExecutor *) parent;
@@ -207,7 +212,7 @@ void TaskFinalization::disposeTask(Task *task)
 			// implementation, the reordering introduced by
 			// unregisterTaskDataAccesses with a Callback causes a use-after-poison
 			// error which is found by ASan.
-			MemoryAllocator::free(disposableBlock, disposableBlockSize);
+			TaskAllocationCache::freeTaskBlock(tasktypeData, disposableBlock, disposableBlockSize);
 
 		} else {
 			// Although collaborators cannot be disposed, they must destroy their
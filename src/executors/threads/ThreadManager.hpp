@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef THREAD_MANAGER_HPP
@@ -89,6 +89,18 @@ public:
 	//! \returns the thread that has been resumed or nullptr
 	static inline WorkerThread *resumeIdle(CPU *idleCPU, bool inInitializationOrShutdown=false, bool doNotCreate=false);
 
+	//! \brief resume an idle thread on each of a set of CPUs
+	//!
+	//! The idle threads of consecutive CPUs of the same NUMA node are taken
+	//! from the idle list at once, so waking many CPUs does not take the lock
+	//! of the list once per CPU
+	//!
+	//! \param[in] idleCPUs the CPUs on which to resume an idle thread
+	//! \param[in] numCPUs the number of CPUs
+	//! \param[in] inInitializationOrShutdown true if it should not enforce assertions that are not valid during initialization and shutdown
+	//! \param[in] doNotCreate true to avoid creating additional threads in case that none is available
+	static inline void resumeIdle(CPU *const idleCPUs[], size_t numCPUs, bool inInitializationOrShutdown=false, bool doNotCreate=false);
+
 	static inline void resumeIdle(const std::vector<CPU *> &idleCPUs, bool inInitializationOrShutdown=false, bool doNotCreate=false);
 
 	static void addShutdownThread(WorkerThread *shutdownThread);
@@ -202,19 +214,58 @@ inline WorkerThread *ThreadManager::resumeIdle(CPU *idleCPU, bool inInitializati
 }
 
 
-inline void ThreadManager::resumeIdle(const std::vector<CPU *> &idleCPUs, bool inInitializationOrShutdown, bool doNotCreate)
+inline void ThreadManager::resumeIdle(CPU *const idleCPUs[], size_t numCPUs, bool inInitializationOrShutdown, bool doNotCreate)
 {
-	for (CPU *idleCPU : idleCPUs) {
-		assert(idleCPU != nullptr);
+	if (numCPUs == 0) {
+		return;
+	}
 
-		// Get an idle thread for the CPU
-		WorkerThread *idleThread = getIdleThread(idleCPU, doNotCreate);
+	WorkerThread *idleThreads[numCPUs];
+
+	size_t first = 0;
+	while (first < numCPUs) {
+		assert(idleCPUs[first] != nullptr);
+
+		// Get the idle threads for a run of CPUs of the same NUMA node
+		const size_t numaNode = idleCPUs[first]->getNumaNodeId();
+		size_t last = first;
+		{
+			IdleThreads &numaIdleThreads = _idleThreads[numaNode];
+
+			std::lock_guard<SpinLock> guard(numaIdleThreads._lock);
+			do {
+				idleThreads[last] = nullptr;
+				if (!numaIdleThreads._threads.empty()) {
+					idleThreads[last] = numaIdleThreads._threads.front();
+					numaIdleThreads._threads.pop_front();
+
+					assert(idleThreads[last] != nullptr);
+					assert(idleThreads[last]->getTask() == nullptr);
+				}
+				++last;
+			} while (last < numCPUs && idleCPUs[last]->getNumaNodeId() == numaNode);
+		}
 
-		if (idleThread != nullptr) {
-			idleThread->resume(idleCPU, inInitializationOrShutdown);
+		for (size_t i = first; i < last; ++i) {
+			WorkerThread *idleThread = idleThreads[i];
+			if (idleThread == nullptr && !doNotCreate) {
+				idleThread = createWorkerThread(idleCPUs[i]);
+			}
+
+			if (idleThread != nullptr) {
+				idleThread->resume(idleCPUs[i], inInitializationOrShutdown);
+			}
 		}
+
+		first = last;
 	}
 }
 
 
+inline void ThreadManager::resumeIdle(const std::vector<CPU *> &idleCPUs, bool inInitializationOrShutdown, bool doNotCreate)
+{
+	resumeIdle(idleCPUs.data(), idleCPUs.size(), inInitializationOrShutdown, doNotCreate);
+}
+
+
 #endif // THREAD_MANAGER_HPP
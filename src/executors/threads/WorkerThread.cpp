@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifdef HAVE_CONFIG_H
@@ -95,9 +95,11 @@ void WorkerThread::body()
 				switchTo(assignedThread);
 			} else {
 				Instrument::workerThreadObtainedTask();
+				cpu->increaseExecutedTasks();
 				// If the task is a taskfor, the CPUManager may want to unidle
-				// collaborators to help execute it
-				if (_task->isTaskfor()) {
+				// collaborators to help execute it. Empty taskfors have no
+				// iterations to share, so there is no need to wake anyone
+				if (_task->isTaskfor() && ((Taskfor *) _task)->getIterationCount() > 0) {
 					CPUManager::executeCPUManagerPolicy(cpu, HANDLE_TASKFOR, 0);
 				}
 
@@ -2,20 +2,21 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
+#include <atomic>
+
 #include "DefaultCPUActivation.hpp"
 #include "DefaultCPUManager.hpp"
 #include "executors/threads/ThreadManager.hpp"
 #include "executors/threads/cpu-managers/default/policies/BusyPolicy.hpp"
+#include "executors/threads/cpu-managers/default/policies/HybridPolicy.hpp"
 #include "executors/threads/cpu-managers/default/policies/IdlePolicy.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "system/TrackingPoints.hpp"
 
-boost::dynamic_bitset<> DefaultCPUManager::_idleCPUs;
-SpinLock DefaultCPUManager::_idleCPUsLock;
-size_t DefaultCPUManager::_numIdleCPUs;
+AtomicBitset<> *DefaultCPUManager::_idleCPUs;
 
 
 /*    CPUMANAGER    */
@@ -61,6 +62,8 @@ void DefaultCPUManager::preinitialize()
 	} else if (policyValue == "busy" || (policyValue == "default" && ClusterManager::inClusterMode())) {
 		// in cluster mode, default is the busy policy
 		_cpuManagerPolicy = new BusyPolicy();
+	} else if (policyValue == "hybrid") {
+		_cpuManagerPolicy = new HybridPolicy(numCPUs);
 	} else {
 		FatalErrorHandler::fail("Unexistent '", policyValue, "' CPU Manager Policy");
 	}
@@ -139,9 +142,8 @@ void DefaultCPUManager::preinitialize()
 	}
 
 	// Initialize idle CPU structures
-	_idleCPUs.resize(numAvailableCPUs);
-	_idleCPUs.reset();
-	_numIdleCPUs = 0;
+	_idleCPUs = new AtomicBitset<>(numAvailableCPUs);
+	assert(_idleCPUs != nullptr);
 
 	// Initialize the virtual CPU for the leader thread
 	if (_reserveCPUforLeaderThread) {
@@ -188,21 +190,7 @@ void DefaultCPUManager::shutdownPhase1()
 
 void DefaultCPUManager::forcefullyResumeFirstCPU()
 {
-	bool resumed = false;
-
-	_idleCPUsLock.lock();
-
-	if (_idleCPUs[_firstCPUId]) {
-		_idleCPUs[_firstCPUId] = false;
-		assert(_numIdleCPUs > 0);
-
-		--_numIdleCPUs;
-		resumed = true;
-	}
-
-	_idleCPUsLock.unlock();
-
-	if (resumed) {
+	if (_idleCPUs->testAndReset(_firstCPUId)) {
 		assert(_cpus[_firstCPUId] != nullptr);
 
 		// Runtime Tracking Point - A cpu becomes active
@@ -244,13 +232,9 @@ bool DefaultCPUManager::cpuBecomesIdle(CPU *cpu)
 
 	const int index = cpu->getIndex();
 
-	std::lock_guard<SpinLock> guard(_idleCPUsLock);
-
 	// If there is no CPU serving tasks in the scheduler,
 	// abort the idle process of this CPU and go back
-	// to the scheduling part. Notice that this check
-	// must be inside the exclusive section covered
-	// by the idle mutex
+	// to the scheduling part
 	if (!Scheduler::isServingTasks()) {
 		return false;
 	}
@@ -259,71 +243,64 @@ bool DefaultCPUManager::cpuBecomesIdle(CPU *cpu)
 	WorkerThread *currentThread = WorkerThread::getCurrentWorkerThread();
 	TrackingPoints::cpuBecomesIdle(cpu, currentThread);
 
-	// Mark the CPU as idle
-	_idleCPUs[index] = true;
-	++_numIdleCPUs;
-	assert(_numIdleCPUs <= _cpus.size());
+	// Mark the CPU as idle before checking whether there is a CPU serving
+	// tasks in the scheduler. A CPU that stops serving tasks requests idle
+	// CPUs after clearing that condition, so with the fences on both sides
+	// either this CPU sees that nobody serves tasks or the other CPU finds
+	// this one in the idle set
+	_idleCPUs->set(index);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// Check it again now that the CPU is visible as idle, and abort the
+	// idle process unless the CPU has already been taken to be resumed
+	if (!Scheduler::isServingTasks() && _idleCPUs->testAndReset(index)) {
+		// Runtime Tracking Point - A cpu becomes active
+		TrackingPoints::cpuBecomesActive(cpu);
+
+		return false;
+	}
 
 	return true;
 }
 
 CPU *DefaultCPUManager::getIdleCPU()
 {
-	_idleCPUsLock.lock();
-
-	boost::dynamic_bitset<>::size_type id = _idleCPUs.find_first();
-	if (id != boost::dynamic_bitset<>::npos) {
-		CPU *cpu = _cpus[id];
-		assert(cpu != nullptr);
-
-		// Mark the CPU as active
-		_idleCPUs[id] = false;
-		assert(_numIdleCPUs > 0);
-
-		--_numIdleCPUs;
-
-		_idleCPUsLock.unlock();
+	CPU *cpu = nullptr;
+	_idleCPUs->resetMatching(1,
+		[&](size_t) -> bool {
+			return true;
+		},
+		[&](size_t id) {
+			cpu = _cpus[id];
+		}
+	);
 
+	if (cpu != nullptr) {
 		// Runtime Tracking Point - A cpu becomes active
 		TrackingPoints::cpuBecomesActive(cpu);
-
-		return cpu;
-	} else {
-		_idleCPUsLock.unlock();
-
-		return nullptr;
 	}
+
+	return cpu;
 }
 
 size_t DefaultCPUManager::getIdleCPUs(
 	size_t numCPUs,
 	CPU *idleCPUs[]
 ) {
-	size_t numObtainedCPUs = 0;
-
-	_idleCPUsLock.lock();
-
-	boost::dynamic_bitset<>::size_type id = _idleCPUs.find_first();
-	while (numObtainedCPUs < numCPUs && id != boost::dynamic_bitset<>::npos) {
-		CPU *cpu = _cpus[id];
-		assert(cpu != nullptr);
-
-		// Mark the CPU as active
-		_idleCPUs[id] = false;
-
-		// Place the CPU in the vector
-		idleCPUs[numObtainedCPUs] = cpu;
-		++numObtainedCPUs;
-
-		// Iterate to the next idle CPU
-		id = _idleCPUs.find_next(id);
-	}
+	// Pairs with the fence of CPUs becoming idle. The caller may have just
+	// stopped serving tasks, and it must find the CPUs that saw it serving
+	std::atomic_thread_fence(std::memory_order_seq_cst);
 
-	// Decrease the counter of idle CPUs by the obtained amount
-	assert(_numIdleCPUs >= numObtainedCPUs);
-	_numIdleCPUs -= numObtainedCPUs;
-
-	_idleCPUsLock.unlock();
+	size_t numObtainedCPUs = 0;
+	_idleCPUs->resetMatching(numCPUs,
+		[&](size_t) -> bool {
+			return true;
+		},
+		[&](size_t id) {
+			assert(_cpus[id] != nullptr);
+			idleCPUs[numObtainedCPUs++] = _cpus[id];
+		}
+	);
 
 	for (size_t i = 0; i < numObtainedCPUs; ++i) {
 		// Runtime Tracking Point - A cpu becomes active
@@ -339,36 +316,21 @@ void DefaultCPUManager::getIdleCollaborators(
 ) {
 	assert(cpu != nullptr);
 
-	size_t numObtainedCollaborators = 0;
 	const size_t groupId = ((CPU *) cpu)->getGroupId();
-
-	_idleCPUsLock.lock();
-
-	boost::dynamic_bitset<>::size_type id = _idleCPUs.find_first();
-	while (id != boost::dynamic_bitset<>::npos) {
-		CPU *collaborator = _cpus[id];
-		assert(collaborator != nullptr);
-
-		if (groupId == collaborator->getGroupId()) {
-			// Mark the CPU as active
-			_idleCPUs[id] = false;
-
-			// Place the CPU in the vector
-			idleCPUs.push_back(collaborator);
-			++numObtainedCollaborators;
+	const size_t firstCollaborator = idleCPUs.size();
+
+	// Take all the idle CPUs of the group at once
+	_idleCPUs->resetMatching(_cpus.size(),
+		[&](size_t id) -> bool {
+			assert(_cpus[id] != nullptr);
+			return (_cpus[id]->getGroupId() == groupId);
+		},
+		[&](size_t id) {
+			idleCPUs.push_back(_cpus[id]);
 		}
+	);
 
-		// Iterate to the next idle CPU
-		id = _idleCPUs.find_next(id);
-	}
-
-	// Decrease the counter of idle CPUs by the obtained amount
-	assert(_numIdleCPUs >= numObtainedCollaborators);
-	_numIdleCPUs -= numObtainedCollaborators;
-
-	_idleCPUsLock.unlock();
-
-	for (size_t i = 0; i < numObtainedCollaborators; ++i) {
+	for (size_t i = firstCollaborator; i < idleCPUs.size(); ++i) {
 		// Runtime Tracking Point - A cpu becomes active
 		TrackingPoints::cpuBecomesActive(idleCPUs[i]);
 	}
@@ -1,27 +1,23 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef DEFAULT_CPU_MANAGER_HPP
 #define DEFAULT_CPU_MANAGER_HPP
 
 #include "executors/threads/CPUManagerInterface.hpp"
+#include "support/bitset/AtomicBitset.hpp"
 
 
 class DefaultCPUManager : public CPUManagerInterface {
 
 private:
 
-	//! Identifies CPUs that are idle
-	static boost::dynamic_bitset<> _idleCPUs;
-
-	//! Spinlock to access idle CPUs
-	static SpinLock _idleCPUsLock;
-
-	//! The current number of idle CPUs, kept atomic through idleCPUsLock
-	static size_t _numIdleCPUs;
+	//! Identifies CPUs that are idle. A CPU is taken out of the idle set
+	//! by the thread that atomically resets its bit, which must resume it
+	static AtomicBitset<> *_idleCPUs;
 
 public:
 
@@ -40,6 +36,7 @@ public:
 		}
 
 		delete _cpuManagerPolicy;
+		delete _idleCPUs;
 
 		// Make sure the policy is nullptr to trip asserts if something's wrong
 		_cpuManagerPolicy = nullptr;
@@ -104,13 +101,8 @@ public:
 
 		// In the default implementation, adding a shutdown CPU means going
 		// through the idle mechanism and thus adding an idle CPU
-		const int index = cpu->getIndex();
-
-		_idleCPUsLock.lock();
-		_idleCPUs[index] = true;
-		++_numIdleCPUs;
-		assert(_numIdleCPUs <= _cpus.size());
-		_idleCPUsLock.unlock();
+		assert(_idleCPUs != nullptr);
+		_idleCPUs->set(cpu->getIndex());
 	}
 
 
@@ -0,0 +1,90 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <algorithm>
+#include <cassert>
+
+#include "HybridPolicy.hpp"
+#include "executors/threads/CPU.hpp"
+#include "lowlevel/SpinWait.hpp"
+#include "support/Chrono.hpp"
+
+#include <InstrumentWorkerThread.hpp>
+
+
+constexpr uint64_t HybridPolicy::MIN_SPIN_WINDOW;
+constexpr uint64_t HybridPolicy::MAX_SPIN_WINDOW;
+constexpr size_t HybridPolicy::MAX_PAUSES;
+
+HybridPolicy::HybridPolicy(size_t numCPUs) :
+	_numCPUs(numCPUs),
+	_idlePolicy(numCPUs)
+{
+	// The policy is created before the memory allocator is initialized
+	_idleStates = new Padded<IdleState>[_numCPUs];
+	assert(_idleStates != nullptr);
+}
+
+HybridPolicy::~HybridPolicy()
+{
+	delete[] _idleStates;
+}
+
+void HybridPolicy::execute(ComputePlace *cpu, CPUManagerPolicyHint hint, size_t numRequested)
+{
+	// NOTE: This policy works as follows:
+	// - If the hint is IDLE_CANDIDATE, the CPU keeps spinning while it is
+	//   within its spinning window, and it is idled afterwards
+	// - If the hint is REQUEST_CPUS or HANDLE_TASKFOR, idle CPUs are woken
+	//   up as in the idle policy
+
+	if (hint != IDLE_CANDIDATE || cpu == nullptr) {
+		_idlePolicy.execute(cpu, hint, numRequested);
+		return;
+	}
+
+	assert(cpu->getIndex() >= 0);
+	assert((size_t) cpu->getIndex() < _numCPUs);
+
+	// Only the thread running on the CPU accesses its state
+	IdleState &state = _idleStates[cpu->getIndex()];
+	const uint64_t now = Chrono::now<uint64_t, std::nano>();
+
+	// The CPU ran some task since its last idle hint if its counter changed
+	const size_t executedTasks = ((CPU *) cpu)->getExecutedTasks();
+	const bool executedWork = (executedTasks != state._executedTasks);
+	state._executedTasks = executedTasks;
+
+	if (state._spinStart == 0 || executedWork) {
+		if (state._spinStart != 0) {
+			// The previous idle period ended while spinning, so learn its length
+			const uint64_t idle = state._lastHint - state._spinStart;
+			state._averageIdle = (3 * state._averageIdle + idle) / 4;
+		}
+
+		state._spinStart = now;
+		state._pauses = 1;
+	}
+
+	const uint64_t window = std::min(std::max(2 * state._averageIdle, MIN_SPIN_WINDOW), MAX_SPIN_WINDOW);
+	if (now - state._spinStart < window) {
+		Instrument::workerThreadBusyWaits();
+
+		for (size_t i = 0; i < state._pauses; ++i) {
+			spinWait();
+		}
+		spinWaitRelease();
+
+		state._pauses = std::min(2 * state._pauses, MAX_PAUSES);
+		state._lastHint = Chrono::now<uint64_t, std::nano>();
+	} else {
+		// No work arrived within the window, so spin for less next time
+		state._averageIdle = std::max(state._averageIdle / 2, MIN_SPIN_WINDOW / 2);
+		state._spinStart = 0;
+
+		_idlePolicy.execute(cpu, hint, numRequested);
+	}
+}
@@ -0,0 +1,81 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef HYBRID_POLICY_HPP
+#define HYBRID_POLICY_HPP
+
+#include <cstdint>
+
+#include "IdlePolicy.hpp"
+#include "executors/threads/CPUManagerPolicyInterface.hpp"
+#include "hardware/places/ComputePlace.hpp"
+#include "lowlevel/Padding.hpp"
+
+
+//! \brief Policy that keeps idle CPUs spinning for a while before idling them
+//!
+//! Each CPU learns how long its idle periods usually last before new work
+//! arrives and keeps polling the scheduler, with an exponential backoff
+//! between polls, for up to twice that time. CPUs that do not find work
+//! within that window are idled as in the idle policy, and the window of
+//! the CPU is halved, so CPUs with long idle periods soon stop spinning
+class HybridPolicy : public CPUManagerPolicyInterface {
+
+private:
+
+	//! Bounds of the spinning window of a CPU, in nanoseconds
+	static constexpr uint64_t MIN_SPIN_WINDOW = 5000;
+	static constexpr uint64_t MAX_SPIN_WINDOW = 500000;
+
+	//! Maximum number of pauses between two polls of the scheduler
+	static constexpr size_t MAX_PAUSES = 256;
+
+	struct IdleState {
+		//! Time when the CPU started spinning, or zero if it is not spinning
+		uint64_t _spinStart;
+
+		//! Time when the CPU finished handling its last idle hint
+		uint64_t _lastHint;
+
+		//! Smoothed duration of the idle periods that ended while spinning
+		uint64_t _averageIdle;
+
+		//! Number of pauses before the next poll of the scheduler
+		size_t _pauses;
+
+		//! Tasks executed by the CPU when it handled its last idle hint
+		size_t _executedTasks;
+
+		IdleState() :
+			_spinStart(0),
+			_lastHint(0),
+			_averageIdle(MAX_SPIN_WINDOW / 4),
+			_pauses(1),
+			_executedTasks(0)
+		{
+		}
+	};
+
+	//! The maximum amount of CPUs in the system
+	size_t _numCPUs;
+
+	//! The idle state of each CPU, indexed by its virtual identifier
+	Padded<IdleState> *_idleStates;
+
+	//! The policy used to idle CPUs and to resume them
+	IdlePolicy _idlePolicy;
+
+public:
+
+	HybridPolicy(size_t numCPUs);
+
+	~HybridPolicy();
+
+	void execute(ComputePlace *cpu, CPUManagerPolicyHint hint, size_t numRequested = 0);
+
+};
+
+#endif // HYBRID_POLICY_HPP
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "IdlePolicy.hpp"
@@ -31,7 +31,15 @@ void IdlePolicy::execute(ComputePlace *cpu, CPUManagerPolicyHint hint, size_t nu
 			assert(currentThread != nullptr);
 
 			// Calls from the Instrument and Monitoring modules can be found within
-			// the "cpuBecomesIdle" function, before releasing the CPU lock
+			// the "cpuBecomesIdle" function, before the CPU is published as idle.
+			// There is no lock to release: the CPU is marked in the idle set
+			// and a fence orders it with the check for CPUs serving tasks.
+			// Once the CPU is idle, any thread may resume it, and it will take
+			// whichever idle thread is first in the list, or create a new one.
+			// That may be a thread other than this one, which then keeps
+			// parked until it is picked for another CPU. If this thread is the
+			// one picked before it parks, its parking spot keeps the unpark
+			// pending and the park returns at once
 
 			ThreadManager::addIdler(currentThread);
 			currentThread->switchTo(nullptr);
@@ -50,10 +58,7 @@ void IdlePolicy::execute(ComputePlace *cpu, CPUManagerPolicyHint hint, size_t nu
 		);
 
 		// Resume an idle thread for every idle CPU that has awakened
-		for (size_t i = 0; i < numCPUsObtained; ++i) {
-			assert(idleCPUs[i] != nullptr);
-			ThreadManager::resumeIdle(idleCPUs[i]);
-		}
+		ThreadManager::resumeIdle(idleCPUs, numCPUsObtained);
 	} else { // hint = HANDLE_TASKFOR
 		assert(cpu != nullptr);
 
@@ -61,9 +66,6 @@ void IdlePolicy::execute(ComputePlace *cpu, CPUManagerPolicyHint hint, size_t nu
 		DefaultCPUManager::getIdleCollaborators(idleCPUs, cpu);
 
 		// Resume an idle thread for every unidled collaborator
-		for (size_t i = 0; i < idleCPUs.size(); ++i) {
-			assert(idleCPUs[i] != nullptr);
-			ThreadManager::resumeIdle(idleCPUs[i]);
-		}
+		ThreadManager::resumeIdle(idleCPUs);
 	}
 }
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2018-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2018-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "ExecutionWorkflowHost.hpp"
@@ -53,9 +53,16 @@ namespace ExecutionWorkflow {
 		// releases the ExecutionStep
 		//
 		// In that case we need to add the Task back for scheduling
-		if ((cpu == nullptr) 
+		//
+		// Taskfors without iterations are never scheduled, since they have
+		// no work for collaborators. Instead, they release their accesses
+		// right away as if all their iterations had completed
+		const bool emptyTaskfor = _task->isTaskforSource()
+			&& (((Taskfor *) _task)->getIterationCount() == 0);
+
+		if (!emptyTaskfor && ((cpu == nullptr)
 			|| (currentThread->getTask() == nullptr)
-			|| (_task->isTaskforSource() && (_task->getExecutionStep() == nullptr))) {
+			|| (_task->isTaskforSource() && (_task->getExecutionStep() == nullptr)))) {
 
 			_task->setExecutionStep(this);
 			Scheduler::addReadyTask(_task, nullptr, BUSY_COMPUTE_PLACE_TASK_HINT);
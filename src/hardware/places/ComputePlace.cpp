@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "ComputePlace.hpp"
@@ -46,6 +46,8 @@ std::vector<MemoryPlace *> ComputePlace::getMemoryPlaces()
 }
 
 ComputePlace::ComputePlace(int index, nanos6_device_t type, bool owned) :
+	_emptyLoopArgsBlock(nullptr),
+	_emptyLoopArgsBlockSize(0),
 	_owned(owned),
 	_randomEngine(index),
 	_index(index),
@@ -112,6 +114,10 @@ ComputePlace::~ComputePlace()
 	} else {
 		MemoryAllocator::free(_preallocatedArgsBlock, _preallocatedArgsBlockSize);
 	}
+
+	if (_emptyLoopArgsBlock != nullptr) {
+		MemoryAllocator::free(_emptyLoopArgsBlock, _emptyLoopArgsBlockSize);
+	}
 }
 
 void *ComputePlace::getPreallocatedArgsBlock(size_t requiredSize)
@@ -131,3 +137,19 @@ void *ComputePlace::getPreallocatedArgsBlock(size_t requiredSize)
 	}
 	return _preallocatedArgsBlock;
 }
+
+void *ComputePlace::getEmptyLoopArgsBlock(size_t requiredSize)
+{
+	// The block is only allocated when needed, once the allocator is available
+	if (requiredSize > _emptyLoopArgsBlockSize) {
+		if (_emptyLoopArgsBlock != nullptr) {
+			MemoryAllocator::free(_emptyLoopArgsBlock, _emptyLoopArgsBlockSize);
+		}
+
+		_emptyLoopArgsBlockSize = requiredSize;
+		_emptyLoopArgsBlock = MemoryAllocator::alloc(_emptyLoopArgsBlockSize);
+		FatalErrorHandler::failIf(_emptyLoopArgsBlock == nullptr,
+			"Insufficient memory for emptyLoopArgsBlock");
+	}
+	return _emptyLoopArgsBlock;
+}
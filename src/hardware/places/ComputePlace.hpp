@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef COMPUTE_PLACE_HPP
@@ -38,6 +38,12 @@ private:
 	//! The size of the preallocated argsBlock
 	size_t _preallocatedArgsBlockSize;
 
+	//! Scratch argsBlock for the loops that are not created
+	void *_emptyLoopArgsBlock;
+
+	//! The size of the scratch argsBlock for loops
+	size_t _emptyLoopArgsBlockSize;
+
 	//! Whether this cpu is owned by the runtime
 	bool _owned;
 
@@ -87,6 +93,10 @@ public:
 
 	void *getPreallocatedArgsBlock(size_t requiredSize);
 
+	//! \brief Get a scratch argsBlock where the compiler can write the
+	//! arguments of a loop that is not created because it has no effect
+	void *getEmptyLoopArgsBlock(size_t requiredSize);
+
 	inline int getIndex() const
 	{
 		return _index;
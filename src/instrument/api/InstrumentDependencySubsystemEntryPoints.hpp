@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -69,6 +69,11 @@ namespace Instrument {
 
 	void exitProcessDelayedOperationsSatisfiedOriginatorsAndRemovableTasks();
 
+	void enterCoalesceFragments();
+
+	//! \param[in] coalescedFragments The number of fragments removed by merging them with the previous one
+	void exitCoalesceFragments(size_t coalescedFragments);
+
 }
 
 #endif //INSTRUMENT_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
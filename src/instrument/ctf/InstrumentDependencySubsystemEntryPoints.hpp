@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_CTF_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -78,6 +78,10 @@ namespace Instrument {
 	inline void enterProcessDelayedOperationsSatisfiedOriginatorsAndRemovableTasks() {};
 
 	inline void exitProcessDelayedOperationsSatisfiedOriginatorsAndRemovableTasks() {};
+
+	inline void enterCoalesceFragments() {};
+
+	inline void exitCoalesceFragments(__attribute__((unused)) size_t coalescedFragments) {};
 }
 
 #endif //INSTRUMENT_CTF_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_EXTRAE_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -187,6 +187,16 @@ namespace Instrument {
 		popDependency(NANOS_PROCESSDELAYEDOPERATIONSSATISFIEDORIGINATORSANDREMOVABLETASKS);
 	}
 
+	inline void enterCoalesceFragments()
+	{
+		pushDependency(NANOS_COALESCEFRAGMENTS);
+	}
+
+	inline void exitCoalesceFragments(__attribute__((unused)) size_t coalescedFragments)
+	{
+		popDependency(NANOS_COALESCEFRAGMENTS);
+	}
+
 
 
 }
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include <nanos6/debug.h>
@@ -52,7 +52,8 @@ namespace Instrument {
 		"UNREGISTERTASKDATAACCESSESCALLBACK", "UNREGISTERTASKDATAACCESSES2",
 		"HANDLECOMPLETEDTASKWAITS", "SETUPTASKWAITWORKFLOW", "RELEASETASKWAITFRAGMENT",
 		"CREATEDATACOPYSTEP_TASK", "CREATEDATACOPYSTEP_TASKWAIT", "TASKDATAACCESSLOCATION",
-		"NANOS_PROCESSDELAYEDOPERATIONSSATISFIEDORIGINATORSANDREMOVABLETASKS"
+		"NANOS_PROCESSDELAYEDOPERATIONSSATISFIEDORIGINATORSANDREMOVABLETASKS",
+		"COALESCEFRAGMENTS"
 	};
 
 	std::atomic<size_t> _nextTaskId(1);
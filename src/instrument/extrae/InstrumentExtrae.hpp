@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_EXTRAE_HPP
@@ -292,6 +292,7 @@ namespace Instrument {
 		NANOS_CREATEDATACOPYSTEP_TASKWAIT,
 		NANOS_TASKDATAACCESSLOCATION,
 		NANOS_PROCESSDELAYEDOPERATIONSSATISFIEDORIGINATORSANDREMOVABLETASKS,
+		NANOS_COALESCEFRAGMENTS,
 		NANOS_DEPENDENCY_STATE_TYPES   // keep this one always at the very end
 	} nanos6_dependency_state_t;
 
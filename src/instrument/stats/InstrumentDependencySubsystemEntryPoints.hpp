@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_VERBOSE_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -122,6 +122,16 @@ namespace Instrument {
 	{
 	}
 
+	inline void enterCoalesceFragments()
+	{
+	}
+
+	inline void exitCoalesceFragments(size_t coalescedFragments)
+	{
+		// Count the fragments that have been merged rather than the passes
+		Stats::nanos6_dependency_state_stats[Stats::NANOS_COALESCEDFRAGMENTS].fetch_add(coalescedFragments);
+	}
+
 }
 
 #endif //INSTRUMENT_VERBOSE_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -207,6 +207,7 @@ if (0) {
 #endif
 
 		show_dependency_state_stats(output);
+		show_memory_stats(output);
 
 		output.close();
 	}
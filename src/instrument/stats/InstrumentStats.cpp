@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "InstrumentStats.hpp"
@@ -10,6 +10,8 @@
 #include <iomanip>      // std::setw
 #include <string>
 
+#include <MemoryAllocator.hpp>
+
 namespace Instrument {
 	namespace Stats {
 		RWTicketSpinLock _phasesSpinLock;
@@ -41,5 +43,22 @@ namespace Instrument {
 			}
 		}
 
+		void show_memory_stats(std::ostream &output)
+		{
+			if (!MemoryAllocator::hasUsageStatistics()) {
+				return;
+			}
+
+			size_t usedBytes, cachedBytes, obtainedBytes;
+			MemoryAllocator::getMemoryStatistics(usedBytes, cachedBytes, obtainedBytes);
+
+			output << "# MEMORY\t" << std::left << std::setw(48) << "Bytes in use"
+				<< std::setw(0) << std::right << "\t" << usedBytes << std::endl;
+			output << "# MEMORY\t" << std::left << std::setw(48) << "Bytes cached"
+				<< std::setw(0) << std::right << "\t" << cachedBytes << std::endl;
+			output << "# MEMORY\t" << std::left << std::setw(48) << "Bytes obtained from OS"
+				<< std::setw(0) << std::right << "\t" << obtainedBytes << std::endl;
+		}
+
 	}
 }
@@ -1,12 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_STATS_HPP
 #define INSTRUMENT_STATS_HPP
 
+#include <array>
+#include <atomic>
 #include <list>
 #include <map>
 #include <vector>
@@ -33,7 +35,8 @@
 	HELPER(NANOS_CREATEDATACOPYSTEP_TASK)				\
 	HELPER(NANOS_CREATEDATACOPYSTEP_TASKWAIT)			\
 	HELPER(NANOS_TASKDATAACCESSLOCATION)				\
-	HELPER(NANOS_PROCESSDELAYEDOPERATIONSSATISFIEDORIGINATORSANDREMOVABLETASKS)
+	HELPER(NANOS_PROCESSDELAYEDOPERATIONSSATISFIEDORIGINATORSANDREMOVABLETASKS)	\
+	HELPER(NANOS_COALESCEDFRAGMENTS)
 
 
 namespace Instrument {
@@ -53,6 +56,8 @@ namespace Instrument {
 
 		void show_dependency_state_stats(std::ostream &output);
 
+		void show_memory_stats(std::ostream &output);
+
 		struct TaskTimes {
 			Timer _instantiationTime;
 			Timer _pendingTime;
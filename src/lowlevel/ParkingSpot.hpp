@@ -0,0 +1,103 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PARKING_SPOT_HPP
+#define PARKING_SPOT_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "lowlevel/FatalErrorHandler.hpp"
+
+
+//! \brief Place where a single thread parks until another thread unparks it
+//!
+//! Parking and unparking only enter the kernel when the thread is actually
+//! asleep or has to sleep, through a private futex on the state of the spot.
+//! An unpark that arrives before the thread parks is kept pending, so the
+//! next park returns immediately
+class ParkingSpot {
+	enum state_t {
+		PARKED = -1,
+		EMPTY = 0,
+		UNPARKED = 1
+	};
+
+	std::atomic<int> _state;
+
+	static_assert(sizeof(std::atomic<int>) == sizeof(int), "Futexes need a plain 32-bit word");
+
+	inline void futexWait()
+	{
+		int rc = syscall(SYS_futex, (int *) &_state, FUTEX_WAIT_PRIVATE, (int) PARKED, nullptr, nullptr, 0);
+		if (rc != 0 && errno != EAGAIN && errno != EINTR) {
+			FatalErrorHandler::fail("Failed to wait on a futex");
+		}
+	}
+
+	inline void futexWake()
+	{
+		int rc = syscall(SYS_futex, (int *) &_state, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+		FatalErrorHandler::failIf(rc < 0, "Failed to wake a futex");
+	}
+
+public:
+	ParkingSpot(const ParkingSpot &) = delete;
+	ParkingSpot operator=(const ParkingSpot &) = delete;
+
+	ParkingSpot() :
+		_state(EMPTY)
+	{
+	}
+
+	//! \brief Park the calling thread until it is unparked
+	void park()
+	{
+		// Consume a pending unpark or announce that the thread sleeps
+		if (_state.fetch_sub(1, std::memory_order_acquire) == UNPARKED) {
+			return;
+		}
+
+		int expected = UNPARKED;
+		while (!_state.compare_exchange_strong(expected, EMPTY, std::memory_order_acquire)) {
+			assert(expected == PARKED);
+			futexWait();
+			expected = UNPARKED;
+		}
+	}
+
+	//! \brief Unpark the thread that is parked or will park on the spot
+	void unpark()
+	{
+		const int previous = _state.exchange(UNPARKED, std::memory_order_release);
+		assert(previous != UNPARKED);
+
+		if (previous == PARKED) {
+			futexWake();
+		}
+	}
+
+	//! \brief Check whether the next park will return immediately
+	bool isUnparkPending() const
+	{
+		return (_state.load(std::memory_order_relaxed) == UNPARKED);
+	}
+
+	//! \brief Discard a pending unpark
+	void clearPendingUnpark()
+	{
+		assert(isUnparkPending());
+		_state.store(EMPTY, std::memory_order_relaxed);
+	}
+};
+
+
+#endif // PARKING_SPOT_HPP
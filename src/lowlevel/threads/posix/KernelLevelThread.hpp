@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef POSIX_KERNEL_LEVEL_THREAD_HPP
@@ -21,8 +21,8 @@
 #include <MemoryAllocator.hpp>
 
 #include "executors/threads/CPU.hpp"
-#include "lowlevel/ConditionVariable.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
+#include "lowlevel/ParkingSpot.hpp"
 
 
 class KernelLevelThread {
@@ -31,8 +31,8 @@ protected:
 	pthread_t _pthread;
 	pid_t _tid;
 
-	//! This condition variable is used for suspending and resuming the thread
-	ConditionVariable _suspensionConditionVariable;
+	//! The spot where the thread parks while it is suspended
+	ParkingSpot _parkingSpot;
 
 	//! stack info to appropriate deallocate it
 	size_t _stackSize;
@@ -96,13 +96,13 @@ public:
 	//! \brief Suspend the thread
 	inline void suspend()
 	{
-		_suspensionConditionVariable.wait();
+		_parkingSpot.park();
 	}
 
 	//! \brief Resume the thread
 	inline void resume()
 	{
-		_suspensionConditionVariable.signal();
+		_parkingSpot.unpark();
 	}
 
 	//! \brief Wait for the thread to finish and join it
@@ -115,13 +115,13 @@ public:
 	//! \brief check if the thread will resume immediately when calling to suspend
 	inline bool willResumeImmediately()
 	{
-		return _suspensionConditionVariable.isPresignaled();
+		return _parkingSpot.isUnparkPending();
 	}
 
 	//! \brief clear the pending resumption mark
 	inline void abortResumption()
 	{
-		_suspensionConditionVariable.clearPresignal();
+		_parkingSpot.clearPendingUnpark();
 	}
 
 	//! \brief code that the thread executes
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MEMORY_ALLOCATOR_HPP
@@ -52,7 +52,20 @@ public:
 		return allocated;
 	}
 
-	static inline void *alloc(size_t size)
+	static inline void getMemoryStatistics(size_t &usedBytes, size_t &cachedBytes, size_t &obtainedBytes)
+	{
+		usedBytes = getMemoryUsage();
+
+		size_t mapped;
+		size_t size = sizeof(mapped);
+		nanos6_je_mallctl("stats.mapped", &mapped, &size, nullptr, 0);
+
+		obtainedBytes = mapped;
+		cachedBytes = (mapped > usedBytes) ? mapped - usedBytes : 0;
+	}
+
+	// The CPU pool hint is only meaningful for the pool allocator
+	static inline void *alloc(size_t size, __attribute__((unused)) bool useCPUPool = false)
 	{
 		assert(size > 0);
 		void *ptr = nanos6_je_mallocx(size, MALLOCX_NONE);
@@ -60,7 +73,7 @@ public:
 		return ptr;
 	}
 
-	static inline void free(void *chunk, size_t size)
+	static inline void free(void *chunk, size_t size, __attribute__((unused)) bool useCPUPool = false)
 	{
 		assert(size > 0);
 		// Failing this assert means the size passed to free does not correspond to the allocated size
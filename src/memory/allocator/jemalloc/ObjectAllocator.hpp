@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef OBJECT_ALLOCATOR_HPP
@@ -22,6 +22,17 @@ public:
 	{
 		MemoryAllocator::deleteObject<T>(ptr);
 	}
+
+	// Objects are not tracked by this allocator
+	static constexpr bool hasObjectStatistics()
+	{
+		return false;
+	}
+
+	static inline size_t getNumObjects()
+	{
+		return 0;
+	}
 };
 
 #endif // OBJECT_ALLOCATOR_HPP
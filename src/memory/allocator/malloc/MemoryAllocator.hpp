@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MEMORY_ALLOCATOR_HPP
@@ -41,7 +41,15 @@ public:
 		return 0;
 	}
 
-	static inline void *alloc(size_t size)
+	static inline void getMemoryStatistics(size_t &usedBytes, size_t &cachedBytes, size_t &obtainedBytes)
+	{
+		usedBytes = 0;
+		cachedBytes = 0;
+		obtainedBytes = 0;
+	}
+
+	// The CPU pool hint is only meaningful for the pool allocator
+	static inline void *alloc(size_t size, __attribute__((unused)) bool useCPUPool = false)
 	{
 		void *ptr;
 
@@ -56,8 +64,11 @@ public:
 		return ptr;
 	}
 
-	static inline void free(void *chunk, __attribute__((unused)) size_t size)
-	{
+	static inline void free(
+		void *chunk,
+		__attribute__((unused)) size_t size,
+		__attribute__((unused)) bool useCPUPool = false
+	) {
 		std::free(chunk);
 	}
 
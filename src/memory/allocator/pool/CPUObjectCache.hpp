@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2018 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef __CPU_OBJECT_CACHE_HPP__
@@ -9,11 +9,11 @@
 
 #include "Poison.hpp"
 #include "lowlevel/SpinLock.hpp"
+#include <algorithm>
 #include <deque>
 
 #include <NUMAObjectCache.hpp>
-#include <VirtualMemoryManagement.hpp>
-#include <MemoryAllocator.hpp>
+#include <ObjectSlab.hpp>
 
 template <typename T>
 class CPUObjectCache {
@@ -21,7 +21,10 @@ class CPUObjectCache {
 	const size_t _NUMANodeId;
 	const size_t _numaNodeCount;
 
+	//! Number of objects requested to the NUMA cache on each miss, which
+	//! doubles on every miss up to the capacity of a slab
 	size_t _allocationSize;
+	const size_t _maxAllocationSize;
 	size_t _objectCounter;
 
 	typedef std::deque<T *> pool_t;
@@ -45,7 +48,8 @@ class CPUObjectCache {
 public:
 	CPUObjectCache(NUMAObjectCache<T> *pool, size_t numaId, size_t numaNodeCount)
 		: _NUMAObjectCache(pool), _NUMANodeId(numaId),
-		  _numaNodeCount(numaNodeCount), _allocationSize(1), _objectCounter(0),
+		  _numaNodeCount(numaNodeCount), _allocationSize(1),
+		  _maxAllocationSize(ObjectSlab<T>::getCapacity()), _objectCounter(0),
 		_available(numaNodeCount + 1)
 	{
 		assert(!_available.empty());
@@ -71,27 +75,22 @@ public:
 		if (local.empty()) {
 			//! Try to recycle from NUMA pool
 			const size_t allocated =
-				_NUMAObjectCache->fillCPUPool(_NUMANodeId, local, 2 * _allocationSize);
+				_NUMAObjectCache->fillCPUPool(_NUMANodeId, local, _allocationSize);
 
-			//! If NUMA pool did not have objects allocate new memory
+			//! If NUMA pool did not have objects allocate a new slab from
+			//! the global pool of our NUMA node
 			if (allocated == 0) {
-				// Prevent overflow
-				assert(_allocationSize < 2 * _allocationSize);
+				const size_t numObjects = ObjectSlab<T>::getCapacity();
+				T *objects = ObjectSlab<T>::create(_NUMANodeId);
 
-				_allocationSize *= 2;
-
-				// Allocate from the per-CPU pool because:
-				// (1) performance-critical and need to avoid taking a lock, and
-				// (2) the CPUObjectCache redistributes free memory among CPUs via NUMAObjectCache
-				T *ptr = (T *) MemoryAllocator::alloc(_allocationSize * sizeof(T), /* useCPUPool */ true);
-				assert(ptr != nullptr);
-
-				AddressSanitizer::poisonMemoryRegion(ptr, _allocationSize * sizeof(T));
-
-				for (size_t i = 0; i < _allocationSize; ++i) {
-					local.push_back(&ptr[i]);
+				for (size_t i = 0; i < numObjects; ++i) {
+					local.push_back(&objects[i]);
 				}
 			}
+
+			if (_allocationSize < _maxAllocationSize) {
+				_allocationSize = std::min(2 * _allocationSize, _maxAllocationSize);
+			}
 		}
 
 		T *ret = local.front();
@@ -107,7 +106,7 @@ public:
 	//! Deallocate an object
 	void deleteObject(T *ptr)
 	{
-		const size_t nodeId = VirtualMemoryManagement::findNUMA((void *)ptr);
+		const size_t nodeId = ObjectSlab<T>::getNUMANodeId(ptr);
 		assert (nodeId < _available.size());
 		ptr->~T();
 
@@ -1,12 +1,15 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
+#include <algorithm>
+
 #include "executors/threads/CPU.hpp"
 #include "executors/threads/WorkerThread.hpp"
 #include "hardware/HardwareInfo.hpp"
+#include "system/RuntimeInfo.hpp"
 #include <VirtualMemoryManagement.hpp>
 
 #include "MemoryAllocator.hpp"
@@ -19,11 +22,16 @@
 
 
 MemoryAllocator *MemoryAllocator::_singleton = nullptr;
+size_t MemoryAllocator::_slabSize = 0;
+std::vector<MemoryAllocator::GlobalRange> MemoryAllocator::_globalRanges;
+RWSpinLock MemoryAllocator::_globalRangesLock;
 
 MemoryAllocator::MemoryAllocator(size_t numaNodeCount, size_t cpuCount) :
 	_globalMemoryPool(numaNodeCount),
 	_localMemoryPool(cpuCount),
 	_externalMemoryPool(),
+	_allPools(nullptr),
+	_slabBytes(0),
 	_cacheLineSize(HardwareInfo::getCacheLineSize())
 {
 	assert(cpuCount > 0);
@@ -31,6 +39,9 @@ MemoryAllocator::MemoryAllocator(size_t numaNodeCount, size_t cpuCount) :
 	for (size_t i = 0; i < numaNodeCount; ++i) {
 		_globalMemoryPool[i] = new MemoryPoolGlobal(i);
 	}
+
+	assert(!_globalMemoryPool.empty());
+	_slabSize = _globalMemoryPool[0]->getChunkSize();
 }
 
 MemoryAllocator::~MemoryAllocator()
@@ -51,6 +62,20 @@ MemoryAllocator::~MemoryAllocator()
 
 	_localMemoryPool.clear();
 	_globalMemoryPool.clear();
+
+	_globalRangesLock.writeLock();
+	_globalRanges.clear();
+	_globalRangesLock.writeUnlock();
+}
+
+void MemoryAllocator::registerPool(MemoryPool *pool)
+{
+	assert(pool != nullptr);
+
+	MemoryPool *head = _allPools.load(std::memory_order_relaxed);
+	do {
+		pool->setNextPool(head);
+	} while (!_allPools.compare_exchange_weak(head, pool, std::memory_order_release, std::memory_order_relaxed));
 }
 
 // Static functions start here
@@ -84,6 +109,7 @@ bool MemoryAllocator::getPool(size_t size, bool useCPUPool, MemoryPool *&pool)
 					// No pool of this size locally
 					pool = new MemoryPool(_globalMemoryPool[numaNodeId], roundedSize);
 					_localMemoryPool[cpuId][cacheLines] = pool;
+					registerPool(pool);
 				} else {
 					pool = it->second;
 				}
@@ -98,6 +124,7 @@ bool MemoryAllocator::getPool(size_t size, bool useCPUPool, MemoryPool *&pool)
 		if (it == _externalMemoryPool.end()) {
 			pool = new MemoryPool(_singleton->_globalMemoryPool[0], roundedSize);
 			_externalMemoryPool[cacheLines] = pool;
+			registerPool(pool);
 		} else {
 			pool = it->second;
 		}
@@ -126,6 +153,11 @@ void MemoryAllocator::initialize()
 	ObjectAllocator<DataAccess>::initialize();
 	ObjectAllocator<ReductionInfo>::initialize();
 	ObjectAllocator<BottomMapEntry>::initialize();
+
+	// Updated every time the runtime information is traversed
+	RuntimeInfo::addEntry("memory_in_use", "Memory In Use", 0L, "bytes");
+	RuntimeInfo::addEntry("memory_cached", "Memory Cached", 0L, "bytes");
+	RuntimeInfo::addEntry("memory_obtained", "Memory Obtained From OS", 0L, "bytes");
 }
 
 void MemoryAllocator::shutdown()
@@ -175,3 +207,100 @@ void MemoryAllocator::free(void *chunk, size_t size, bool useCPUPool)
 		pool->returnChunk(chunk);
 	}
 }
+
+void MemoryAllocator::registerGlobalRange(void *start, size_t size, MemoryPoolGlobal *globalPool)
+{
+	assert(start != nullptr);
+	assert(globalPool != nullptr);
+
+	GlobalRange range;
+	range._start = (uintptr_t) start;
+	range._end = range._start + size;
+	range._globalPool = globalPool;
+
+	_globalRangesLock.writeLock();
+	auto it = std::upper_bound(_globalRanges.begin(), _globalRanges.end(), range,
+		[](const GlobalRange &a, const GlobalRange &b) { return a._start < b._start; });
+	_globalRanges.insert(it, range);
+	_globalRangesLock.writeUnlock();
+}
+
+MemoryPoolGlobal *MemoryAllocator::getGlobalPool(void *chunk)
+{
+	const uintptr_t address = (uintptr_t) chunk;
+	MemoryPoolGlobal *globalPool = nullptr;
+
+	_globalRangesLock.readLock();
+	auto it = std::upper_bound(_globalRanges.begin(), _globalRanges.end(), address,
+		[](uintptr_t value, const GlobalRange &range) { return value < range._start; });
+	if (it != _globalRanges.begin()) {
+		--it;
+		if (address < it->_end) {
+			globalPool = it->_globalPool;
+		}
+	}
+	_globalRangesLock.readUnlock();
+
+	return globalPool;
+}
+
+void *MemoryAllocator::allocSlab(size_t numaNodeId)
+{
+	assert(_singleton != nullptr);
+	assert(numaNodeId < _singleton->_globalMemoryPool.size());
+
+	_singleton->_slabBytes.fetch_add(_slabSize, std::memory_order_relaxed);
+	return _singleton->_globalMemoryPool[numaNodeId]->getSlab();
+}
+
+void MemoryAllocator::freeSlab(void *slab, size_t numaNodeId)
+{
+	assert(_singleton != nullptr);
+	assert(numaNodeId < _singleton->_globalMemoryPool.size());
+	assert(((uintptr_t) slab & (_slabSize - 1)) == 0);
+
+	_singleton->_globalMemoryPool[numaNodeId]->returnSlab(slab);
+	_singleton->_slabBytes.fetch_sub(_slabSize, std::memory_order_relaxed);
+}
+
+size_t MemoryAllocator::getMemoryUsage()
+{
+	assert(_singleton != nullptr);
+
+	long usedBytes = _singleton->_slabBytes.load(std::memory_order_relaxed);
+	MemoryPool *pool = _singleton->_allPools.load(std::memory_order_acquire);
+	while (pool != nullptr) {
+		usedBytes += pool->getUsedBytes();
+		pool = pool->getNextPool();
+	}
+
+	// The counters are read while they change, so the sum may be transiently negative
+	return (usedBytes > 0) ? (size_t) usedBytes : 0;
+}
+
+void MemoryAllocator::getMemoryStatistics(size_t &usedBytes, size_t &cachedBytes, size_t &obtainedBytes)
+{
+	usedBytes = 0;
+	cachedBytes = 0;
+	obtainedBytes = 0;
+
+	// The runtime information may be traversed before the initialization
+	if (_singleton == nullptr)
+		return;
+
+	usedBytes = getMemoryUsage();
+
+	MemoryPool *pool = _singleton->_allPools.load(std::memory_order_acquire);
+	while (pool != nullptr) {
+		cachedBytes += pool->getCachedBytes();
+		pool = pool->getNextPool();
+	}
+
+	for (MemoryPoolGlobal *globalPool : _singleton->_globalMemoryPool) {
+		size_t globalCachedBytes, globalObtainedBytes;
+		globalPool->getStatistics(globalCachedBytes, globalObtainedBytes);
+
+		cachedBytes += globalCachedBytes;
+		obtainedBytes += globalObtainedBytes;
+	}
+}
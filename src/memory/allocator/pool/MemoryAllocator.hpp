@@ -1,16 +1,19 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MEMORY_ALLOCATOR_HPP
 #define MEMORY_ALLOCATOR_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <vector>
 
+#include "lowlevel/RWSpinLock.hpp"
 #include "lowlevel/SpinLock.hpp"
 
 class MemoryPool;
@@ -33,8 +36,32 @@ private:
 	SpinLock _externalMemoryPoolLock;
 	size_to_pool_t _externalMemoryPool;
 
+	//! List of all the CPU and external pools, used to gather the usage
+	//! statistics without accessing the pool maps of other CPUs
+	std::atomic<MemoryPool *> _allPools;
+
+	//! Bytes in the slabs of the object caches
+	std::atomic<size_t> _slabBytes;
+
+	//! Size of the slabs, which is the chunk size of the global pools
+	static size_t _slabSize;
+
+	//! A block of memory obtained by a global pool from the system
+	struct GlobalRange {
+		uintptr_t _start;
+		uintptr_t _end;
+		MemoryPoolGlobal *_globalPool;
+	};
+
+	//! Blocks obtained by all the global pools, sorted by address. They are
+	//! used to find the NUMA node of a chunk freed in a CPU of another node
+	static std::vector<GlobalRange> _globalRanges;
+	static RWSpinLock _globalRangesLock;
+
 	bool getPool(size_t size, bool useCPUPool, MemoryPool *&pool);
 
+	void registerPool(MemoryPool *pool);
+
 	MemoryAllocator(size_t numaNodeCount, size_t cpuCount);
 	~MemoryAllocator();
 
@@ -46,23 +73,72 @@ public:
 	static void initialize();
 	static void shutdown();
 
-	// Only allocate and free from the CPU pool if:
-	// (1) performance-critical and need to avoid taking a lock, and
-	// (2) either alloc and free happen on the same CPU or there is
-	//     a mechanism to redistribute free memory among cores
+	// Only allocate and free from the CPU pool if performance-critical and
+	// need to avoid taking a lock. Memory freed in a CPU other than the one
+	// that allocated it is cached by the freeing CPU up to the high-water mark
+	// (memory.pool.cpu_high_water), and then returned to the global pool of
+	// the NUMA node it comes from
 	static void *alloc(size_t size, bool useCPUPool = false);
 	static void free(void *chunk, size_t size, bool useCPUPool = false);
 
-	static constexpr bool hasUsageStatistics()
+	//! \brief Register a block that a global pool obtained from the system
+	//!
+	//! \param[in] start The start of the block
+	//! \param[in] size The size of the block
+	//! \param[in] globalPool The global pool that owns the block
+	static void registerGlobalRange(void *start, size_t size, MemoryPoolGlobal *globalPool);
+
+	//! \brief Get the global pool, and thus the NUMA node, of a chunk
+	//!
+	//! \param[in] chunk A chunk handed out by any of the pools
+	//!
+	//! \returns The global pool whose memory contains the chunk, or nullptr
+	//! if it does not belong to any of them
+	static MemoryPoolGlobal *getGlobalPool(void *chunk);
+
+	//! \brief Check whether the memory comes from several NUMA nodes
+	static inline bool hasSeveralNUMANodes()
 	{
-		return false;
+		assert(_singleton != nullptr);
+		return (_singleton->_globalMemoryPool.size() > 1);
 	}
 
-	static inline size_t getMemoryUsage()
+	//! \brief Allocate a slab for the object caches
+	//!
+	//! \param[in] numaNodeId The NUMA node whose global pool provides the slab
+	//!
+	//! \returns A block of getSlabSize() bytes aligned to its size
+	static void *allocSlab(size_t numaNodeId);
+
+	//! \brief Return a slab to the global pool of its NUMA node
+	static void freeSlab(void *slab, size_t numaNodeId);
+
+	//! \brief Get the size of the slabs, which is a power of two
+	static inline size_t getSlabSize()
 	{
-		return 0;
+		return _slabSize;
 	}
 
+	static constexpr bool hasUsageStatistics()
+	{
+		return true;
+	}
+
+	//! \brief Get the bytes currently allocated by the runtime
+	static size_t getMemoryUsage();
+
+	//! \brief Get the detailed usage statistics of the allocator
+	//!
+	//! The statistics are gathered from all the pools without stopping them,
+	//! so they are an approximation while the runtime is running
+	//!
+	//! All of them are zero before the allocator is initialized
+	//!
+	//! \param[out] usedBytes The bytes currently allocated
+	//! \param[out] cachedBytes The bytes kept free in the pools
+	//! \param[out] obtainedBytes The bytes obtained from the system
+	static void getMemoryStatistics(size_t &usedBytes, size_t &cachedBytes, size_t &obtainedBytes);
+
 	/* Simplifications for using "new" and "delete" with the allocator */
 	template <typename T, typename... Args>
 	static T *newObject(Args &&... args)
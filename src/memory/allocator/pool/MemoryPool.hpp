@@ -1,12 +1,16 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MEMORY_POOL_HPP
 #define MEMORY_POOL_HPP
 
+#include <algorithm>
+#include <atomic>
+
+#include "MemoryAllocator.hpp"
 #include "MemoryPoolGlobal.hpp"
 
 #include "Poison.hpp"
@@ -20,13 +24,119 @@ private:
 	const size_t _chunkSize;
 	void *_topChunk;
 
+	// Number of chunks currently linked in _topChunk
+	size_t _freeChunks;
+
+	// Usage statistics. They are only written by the thread that owns the
+	// pool, but they may be read by any thread. Chunks allocated in a pool
+	// and freed in another make the counters of each pool drift, but their
+	// sum across all pools is exact
+	std::atomic<long> _usedChunksStat;
+	std::atomic<size_t> _freeChunksStat;
+
+	// Next pool in the list of all pools of the allocator
+	MemoryPool *_nextPool;
+
+	// Maximum number of free chunks cached by this pool. Chunks that are
+	// allocated in one CPU and freed in another accumulate in the pool of
+	// the freeing CPU; once that pool exceeds this mark, the surplus is
+	// handed back to the global pools of the NUMA nodes where it comes
+	// from, so that other CPUs can reuse it
+	const size_t _highWaterMark;
+
 	MemoryPool() = delete;
 
+	//! \brief Return the surplus of free chunks to the global pool
+	//!
+	//! The most recently freed chunks, which are the most likely to be
+	//! cache-hot, are kept in the pool. The rest are returned as a single
+	//! batch, so the cost of walking the list is amortized over the
+	//! returnChunk calls that made the pool grow past the high-water mark
+	void reclaimChunks()
+	{
+		const size_t keep = _highWaterMark / 2;
+		assert(keep > 0);
+		assert(_freeChunks > keep);
+
+		void *lastKept = _topChunk;
+		for (size_t i = 1; i < keep; ++i) {
+			AddressSanitizer::unpoisonMemoryRegion(lastKept, sizeof(void *));
+			void *next = NEXT_CHUNK(lastKept);
+			AddressSanitizer::poisonMemoryRegion(lastKept, sizeof(void *));
+			lastKept = next;
+		}
+
+		AddressSanitizer::unpoisonMemoryRegion(lastKept, sizeof(void *));
+		void *surplus = NEXT_CHUNK(lastKept);
+		NEXT_CHUNK(lastKept) = nullptr;
+		AddressSanitizer::poisonMemoryRegion(lastKept, sizeof(void *));
+
+		assert(surplus != nullptr);
+		if (MemoryAllocator::hasSeveralNUMANodes()) {
+			returnChunksToHomeNodes(surplus);
+		} else {
+			_globalAllocator->returnChunks(_chunkSize, surplus, _freeChunks - keep);
+		}
+		_freeChunks = keep;
+	}
+
+	//! \brief Get the global pool that provided the memory of a chunk
+	inline MemoryPoolGlobal *getHomePool(void *chunk) const
+	{
+		MemoryPoolGlobal *homePool = MemoryAllocator::getGlobalPool(chunk);
+		return (homePool != nullptr) ? homePool : _globalAllocator;
+	}
+
+	//! \brief Return a list of free chunks to the global pools of their nodes
+	//!
+	//! Chunks freed in this CPU may have been allocated in a CPU of another
+	//! NUMA node. Each run of consecutive chunks from the same node is given
+	//! back to the global pool of that node as a single batch
+	void returnChunksToHomeNodes(void *chunk)
+	{
+		while (chunk != nullptr) {
+			MemoryPoolGlobal *homePool = getHomePool(chunk);
+			void *firstChunk = chunk;
+			void *lastChunk;
+			size_t numChunks = 0;
+
+			do {
+				lastChunk = chunk;
+				++numChunks;
+
+				AddressSanitizer::unpoisonMemoryRegion(chunk, sizeof(void *));
+				chunk = NEXT_CHUNK(chunk);
+				AddressSanitizer::poisonMemoryRegion(lastChunk, sizeof(void *));
+			} while (chunk != nullptr && getHomePool(chunk) == homePool);
+
+			AddressSanitizer::unpoisonMemoryRegion(lastChunk, sizeof(void *));
+			NEXT_CHUNK(lastChunk) = nullptr;
+			AddressSanitizer::poisonMemoryRegion(lastChunk, sizeof(void *));
+
+			homePool->returnChunks(_chunkSize, firstChunk, numChunks);
+		}
+	}
+
+	//! \brief Publish the usage statistics after a change
+	inline void updateStatistics(long usedChunksDelta)
+	{
+		// Relaxed load and store, since there is a single writer
+		_usedChunksStat.store(
+			_usedChunksStat.load(std::memory_order_relaxed) + usedChunksDelta,
+			std::memory_order_relaxed);
+		_freeChunksStat.store(_freeChunks, std::memory_order_relaxed);
+	}
+
 public:
 	MemoryPool(MemoryPoolGlobal *globalAllocator, size_t chunkSize)
 		: _globalAllocator(globalAllocator),
 		_chunkSize(chunkSize),
-		_topChunk(nullptr)
+		_topChunk(nullptr),
+		_freeChunks(0),
+		_usedChunksStat(0),
+		_freeChunksStat(0),
+		_nextPool(nullptr),
+		_highWaterMark(std::max(globalAllocator->getCPUHighWaterMark() / chunkSize, (size_t) 2))
 	{
 		assert (_chunkSize > 0);
 		assert (_globalAllocator != nullptr);
@@ -35,6 +145,11 @@ public:
 	void *getChunk()
 	{
 		if (_topChunk == nullptr) { // Fill Pool
+			// First try to reuse chunks of this size that other pools returned
+			_topChunk = _globalAllocator->getReturnedChunks(_chunkSize, _freeChunks);
+		}
+
+		if (_topChunk == nullptr) {
 			size_t globalChunkSize;
 			_topChunk = _globalAllocator->getMemory(_chunkSize, globalChunkSize);
 
@@ -55,16 +170,20 @@ public:
 			}
 
 			NEXT_CHUNK(prevChunk) = nullptr;
+			_freeChunks = numChunks;
 
 			// Poison whole region
 			AddressSanitizer::poisonMemoryRegion(_topChunk, globalChunkSize);
 		}
 
 		void *chunk = _topChunk;
+		assert(_freeChunks > 0);
 
 		// Unpoison chunk
 		AddressSanitizer::unpoisonMemoryRegion(chunk, _chunkSize);
 		_topChunk = NEXT_CHUNK(chunk);
+		--_freeChunks;
+		updateStatistics(1);
 
 		return chunk;
 	}
@@ -73,9 +192,40 @@ public:
 	{
 		NEXT_CHUNK(chunk) = _topChunk;
 		_topChunk = chunk;
+		++_freeChunks;
 
 		// Poison now it is in the linked list
 		AddressSanitizer::poisonMemoryRegion(chunk, _chunkSize);
+
+		if (_freeChunks > _highWaterMark) {
+			reclaimChunks();
+		}
+		updateStatistics(-1);
+	}
+
+	//! \brief Get the bytes allocated from this pool and not freed yet
+	//!
+	//! The value is negative if this pool received more chunks from other
+	//! pools than the chunks it handed out
+	inline long getUsedBytes() const
+	{
+		return _usedChunksStat.load(std::memory_order_relaxed) * (long) _chunkSize;
+	}
+
+	//! \brief Get the bytes of the free chunks cached in this pool
+	inline size_t getCachedBytes() const
+	{
+		return _freeChunksStat.load(std::memory_order_relaxed) * _chunkSize;
+	}
+
+	inline MemoryPool *getNextPool() const
+	{
+		return _nextPool;
+	}
+
+	inline void setNextPool(MemoryPool *nextPool)
+	{
+		_nextPool = nextPool;
 	}
 };
 
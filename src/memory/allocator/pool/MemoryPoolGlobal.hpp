@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MEMORY_POOL_GLOBAL_HPP
@@ -15,9 +15,13 @@
 #include <memkind.h>
 #endif
 
+#include <algorithm>
+#include <cstdint>
+#include <map>
 #include <numa.h>
 #include <vector>
 
+#include "MemoryAllocator.hpp"
 #include "lowlevel/SpinLock.hpp"
 #include "support/config/ConfigVariable.hpp"
 
@@ -29,9 +33,29 @@ class MemoryPoolGlobal {
 private:
 	ConfigVariable<StringifiedMemorySize> _globalAllocSizeConfig;
 	ConfigVariable<StringifiedMemorySize> _memoryChunkSizeConfig;
+	ConfigVariable<StringifiedMemorySize> _cpuHighWaterMarkConfig;
 
 	size_t _globalAllocSize;
 	size_t _memoryChunkSize;
+	size_t _cpuHighWaterMark;
+
+	//! Header written in the first chunk of a batch returned by a CPU pool.
+	//! The first field overlaps the link used by the CPU pools, so the chunks
+	//! of a batch remain linked exactly as they were in the returning pool
+	struct ReturnedBatch {
+		void *_nextChunk;
+		ReturnedBatch *_nextBatch;
+		size_t _numChunks;
+	};
+
+	//! Batches of free chunks returned by the CPU pools, indexed by chunk size
+	std::map<size_t, ReturnedBatch *> _returnedBatches;
+
+	//! Bytes in _returnedBatches
+	size_t _returnedBytes;
+
+	//! Bytes obtained from the system
+	size_t _obtainedBytes;
 
 	SpinLock _lock;
 	size_t _pageSize;
@@ -49,36 +73,61 @@ private:
 			allocSize = _globalAllocSize;
 		}
 
+#if !HAVE_MEMKIND
+		// Keep the following blocks aligned to the pages of the region, which
+		// may be huge pages, so that each block can be bound to its NUMA node
+		allocSize = ROUND_UP(allocSize, VirtualMemoryManagement::getPageSize());
+#endif
+
+		// The block is aligned to the chunk size, so that all the chunks are
+		// aligned to their size and can be used as slabs by the object caches
 		_curAvailable = allocSize;
 #if HAVE_MEMKIND
-		int rc = memkind_posix_memalign(_memoryKind, &_curMemoryChunk, _pageSize, allocSize);
+		int rc = memkind_posix_memalign(_memoryKind, &_curMemoryChunk,
+			std::max(_pageSize, _memoryChunkSize), allocSize);
 		FatalErrorHandler::failIf(
 			rc != MEMKIND_SUCCESS,
 			" When trying to allocate a memory chunk for the global allocator"
 		);
 #else
-		_curMemoryChunk = VirtualMemoryManagement::allocLocalNUMA(allocSize, _NUMANodeId);
+		if (_memoryChunkSize > VirtualMemoryManagement::getPageSize()) {
+			allocSize += _memoryChunkSize;
+		}
+
+		void *block = VirtualMemoryManagement::allocLocalNUMA(allocSize, _NUMANodeId);
 		FatalErrorHandler::failIf(
-			_curMemoryChunk == nullptr,
+			block == nullptr,
 			" Could not allocate a memory chunk for the global allocator. allocSize = ", allocSize,
 			" Numa node: ", _NUMANodeId
 		);
+
+		_curMemoryChunk = (void *) ROUND_UP((uintptr_t) block, _memoryChunkSize);
 #endif
 
 		if (numa_available() != -1) {
-			numa_setlocal_memory(_curMemoryChunk, allocSize);
+			numa_setlocal_memory(_curMemoryChunk, _curAvailable);
 		}
 
-		AddressSanitizer::poisonMemoryRegion(_curMemoryChunk, allocSize);
+		AddressSanitizer::poisonMemoryRegion(_curMemoryChunk, _curAvailable);
 		_oldMemoryChunks.push_back(_curMemoryChunk);
+		_obtainedBytes += allocSize;
+
+		// Chunks of this block may be freed in CPUs of other NUMA nodes, which
+		// have to find the global pool they come from
+		MemoryAllocator::registerGlobalRange(_curMemoryChunk, _curAvailable, this);
 	}
 
 public:
 	MemoryPoolGlobal(size_t NUMANodeId) :
 		_globalAllocSizeConfig("memory.pool.global_alloc_size"),
 		_memoryChunkSizeConfig("memory.pool.chunk_size"),
+		_cpuHighWaterMarkConfig("memory.pool.cpu_high_water"),
 		_globalAllocSize(0),
 		_memoryChunkSize(0),
+		_cpuHighWaterMark(0),
+		_returnedBatches(),
+		_returnedBytes(0),
+		_obtainedBytes(0),
 		_pageSize(sysconf(_SC_PAGESIZE)),
 		_oldMemoryChunks(0),
 		_curMemoryChunk(nullptr),
@@ -87,9 +136,15 @@ public:
 	{
 		_globalAllocSize = _globalAllocSizeConfig.getValue();
 		_memoryChunkSize = _memoryChunkSizeConfig.getValue();
+		_cpuHighWaterMark = _cpuHighWaterMarkConfig.getValue();
 
 		FatalErrorHandler::failIf(_globalAllocSize == 0, " Pool size can not be zero");
 
+		FatalErrorHandler::failIf(
+			(_memoryChunkSize & (_memoryChunkSize - 1)) != 0,
+			" Chunk size must be a power of two"
+		);
+
 		FatalErrorHandler::failIf(
 			(_globalAllocSize % _memoryChunkSize) != 0,
 			" Pool size and chunk size must be multiples of each other"
@@ -149,6 +204,116 @@ public:
 		AddressSanitizer::unpoisonMemoryRegion(curAddr, chunkSize);
 		return curAddr;
 	}
+
+	//! \brief Get the size of the chunks, which are aligned to it
+	inline size_t getChunkSize() const
+	{
+		return _memoryChunkSize;
+	}
+
+	//! \brief Get a single chunk to be used as a slab
+	//!
+	//! Slabs returned to the pool are stored as batches of one chunk, and are
+	//! reused both by the object caches and the CPU pools of the same size
+	void *getSlab()
+	{
+		size_t numChunks;
+		void *slab = getReturnedChunks(_memoryChunkSize, numChunks);
+		if (slab == nullptr) {
+			size_t chunkSize;
+			slab = getMemory(_memoryChunkSize, chunkSize);
+			assert(chunkSize == _memoryChunkSize);
+			return slab;
+		}
+
+		AddressSanitizer::unpoisonMemoryRegion(slab, _memoryChunkSize);
+		if (numChunks > 1) {
+			// Keep the rest of the batch in the pool
+			returnChunks(_memoryChunkSize, *((void **) slab), numChunks - 1);
+		}
+
+		return slab;
+	}
+
+	//! \brief Return a slab obtained through getSlab
+	void returnSlab(void *slab)
+	{
+		AddressSanitizer::poisonMemoryRegion(slab, _memoryChunkSize);
+		AddressSanitizer::unpoisonMemoryRegion(slab, sizeof(void *));
+		*((void **) slab) = nullptr;
+		AddressSanitizer::poisonMemoryRegion(slab, sizeof(void *));
+
+		returnChunks(_memoryChunkSize, slab, 1);
+	}
+
+	//! \brief Get the usage statistics of this pool
+	//!
+	//! \param[out] cachedBytes The bytes not handed out to the CPU pools
+	//! \param[out] obtainedBytes The bytes obtained from the system
+	void getStatistics(size_t &cachedBytes, size_t &obtainedBytes)
+	{
+		std::lock_guard<SpinLock> guard(_lock);
+		cachedBytes = _curAvailable + _returnedBytes;
+		obtainedBytes = _obtainedBytes;
+	}
+
+	//! \brief Get the maximum amount of free memory that a CPU pool caches
+	inline size_t getCPUHighWaterMark() const
+	{
+		return _cpuHighWaterMark;
+	}
+
+	//! \brief Receive a list of free chunks from a CPU pool
+	//!
+	//! \param[in] chunkSize The size of each chunk in the list
+	//! \param[in] firstChunk The first chunk of a null-terminated list
+	//! \param[in] numChunks The number of chunks in the list
+	void returnChunks(size_t chunkSize, void *firstChunk, size_t numChunks)
+	{
+		assert(chunkSize >= sizeof(ReturnedBatch));
+		assert(firstChunk != nullptr);
+		assert(numChunks > 0);
+
+		ReturnedBatch *batch = (ReturnedBatch *) firstChunk;
+		AddressSanitizer::unpoisonMemoryRegion(batch, sizeof(ReturnedBatch));
+		batch->_numChunks = numChunks;
+
+		std::lock_guard<SpinLock> guard(_lock);
+		ReturnedBatch *&head = _returnedBatches[chunkSize];
+		batch->_nextBatch = head;
+		head = batch;
+		_returnedBytes += numChunks * chunkSize;
+
+		AddressSanitizer::poisonMemoryRegion(batch, sizeof(ReturnedBatch));
+	}
+
+	//! \brief Get a list of free chunks previously returned by a CPU pool
+	//!
+	//! \param[in] chunkSize The size of the requested chunks
+	//! \param[out] numChunks The number of chunks in the returned list
+	//!
+	//! \returns A null-terminated list of chunks, or nullptr if there are none
+	void *getReturnedChunks(size_t chunkSize, size_t &numChunks)
+	{
+		std::lock_guard<SpinLock> guard(_lock);
+
+		auto it = _returnedBatches.find(chunkSize);
+		if (it == _returnedBatches.end() || it->second == nullptr) {
+			numChunks = 0;
+			return nullptr;
+		}
+
+		ReturnedBatch *batch = it->second;
+		AddressSanitizer::unpoisonMemoryRegion(batch, sizeof(ReturnedBatch));
+		it->second = batch->_nextBatch;
+		numChunks = batch->_numChunks;
+		AddressSanitizer::poisonMemoryRegion(batch, sizeof(ReturnedBatch));
+
+		assert(_returnedBytes >= numChunks * chunkSize);
+		_returnedBytes -= numChunks * chunkSize;
+
+		return batch;
+	}
 };
 
 #endif // MEMORY_POOL_GLOBAL_HPP
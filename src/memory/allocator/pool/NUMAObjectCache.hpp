@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2018 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef __NUMA_OBJECT_CACHE_HPP__
@@ -9,10 +9,13 @@
 
 #include "lowlevel/PaddedSpinLock.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <deque>
 #include <mutex>
 
+#include <ObjectSlab.hpp>
+
 template <typename T>
 class NUMAObjectCache {
 
@@ -20,14 +23,55 @@ class NUMAObjectCache {
 	typedef struct {
 		PaddedSpinLock<> _lock;
 		pool_t _pool;
+		//! Pool size that triggers the next search for empty slabs
+		size_t _reclaimThreshold;
 	} NUMApool_t;
 
 	std::vector<NUMApool_t> _NUMAPools;
 
+	//! Minimum number of objects kept in a NUMA pool before looking for
+	//! empty slabs
+	const size_t _minReclaimThreshold;
+
+	//! \brief Return the slabs that have all their objects in a pool
+	//!
+	//! The pool is sorted by address, so the objects of a slab are contiguous
+	//! and the empty slabs are the groups with as many objects as a slab holds
+	static void reclaimSlabs(pool_t &pool)
+	{
+		const size_t capacity = ObjectSlab<T>::getCapacity();
+
+		std::sort(pool.begin(), pool.end());
+
+		typename pool_t::iterator kept = pool.begin();
+		typename pool_t::iterator it = pool.begin();
+		while (it != pool.end()) {
+			void *slab = ObjectSlab<T>::getSlab(*it);
+
+			typename pool_t::iterator last = it;
+			while (last != pool.end() && ObjectSlab<T>::getSlab(*last) == slab) {
+				++last;
+			}
+
+			if ((size_t) (last - it) == capacity) {
+				ObjectSlab<T>::destroy(slab);
+			} else {
+				kept = std::move(it, last, kept);
+			}
+			it = last;
+		}
+
+		pool.erase(kept, pool.end());
+	}
+
 public:
 	NUMAObjectCache(size_t NUMANodeCount)
-		: _NUMAPools(NUMANodeCount + 1)
+		: _NUMAPools(NUMANodeCount + 1),
+		_minReclaimThreshold(4 * ObjectSlab<T>::getCapacity())
 	{
+		for (NUMApool_t &numaPool : _NUMAPools) {
+			numaPool._reclaimThreshold = _minReclaimThreshold;
+		}
 	}
 
 	~NUMAObjectCache()
@@ -65,15 +109,37 @@ public:
 	 *
 	 * This is typically called from a CPUNUMAObjectCache in order to return
 	 * objects related with a different NUMA node than the one it belongs.
+	 *
+	 * Each time the NUMA pool doubles its size since the last search, the
+	 * slabs that have become empty are returned to the global pool of the
+	 * NUMA node. The search is done outside the lock, so the cost of sorting
+	 * the pool is amortized over the returned objects without blocking the
+	 * allocations of the other CPUs.
 	 */
 	void returnObjects(size_t numaId, std::deque<T *> &pool, size_t start = 0)
 	{
 		assert(numaId < _NUMAPools.size());
 
-		std::lock_guard<PaddedSpinLock<>> lock(_NUMAPools[numaId]._lock);
-		pool_t &numaPool = _NUMAPools[numaId]._pool;
-		std::move(pool.begin() + start, pool.end(), std::back_inserter(numaPool));
+		NUMApool_t &numaPool = _NUMAPools[numaId];
+		pool_t reclaimable;
+		{
+			std::lock_guard<PaddedSpinLock<>> lock(numaPool._lock);
+			std::move(pool.begin() + start, pool.end(), std::back_inserter(numaPool._pool));
+			if (numaPool._pool.size() >= numaPool._reclaimThreshold) {
+				reclaimable.swap(numaPool._pool);
+			}
+		}
 		pool.erase(pool.begin() + start, pool.end());
+
+		if (reclaimable.empty()) {
+			return;
+		}
+
+		reclaimSlabs(reclaimable);
+
+		std::lock_guard<PaddedSpinLock<>> lock(numaPool._lock);
+		numaPool._reclaimThreshold = std::max(2 * reclaimable.size(), _minReclaimThreshold);
+		std::move(reclaimable.begin(), reclaimable.end(), std::back_inserter(numaPool._pool));
 	}
 };
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef __OBJECT_ALLOCATOR_HPP__
@@ -42,6 +42,18 @@ public:
 	{
 		_cache->deleteObject(ptr);
 	}
+
+	static constexpr bool hasObjectStatistics()
+	{
+		return true;
+	}
+
+	//! \brief Get an estimation of the number of live objects
+	static inline size_t getNumObjects()
+	{
+		assert(_cache != nullptr);
+		return _cache->getNumObject();
+	}
 };
 
 
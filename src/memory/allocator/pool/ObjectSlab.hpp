@@ -0,0 +1,86 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __OBJECT_SLAB_HPP__
+#define __OBJECT_SLAB_HPP__
+
+#include <cassert>
+#include <cstdint>
+
+#include "Poison.hpp"
+#include "lowlevel/Padding.hpp"
+
+#include <MemoryAllocator.hpp>
+
+//! A slab is a block of memory of MemoryAllocator::getSlabSize() bytes, aligned
+//! to its own size, that holds objects of a single type. The slab header records
+//! the NUMA node of the memory, so the node of any object is found by masking
+//! its address instead of searching the NUMA regions
+template <typename T>
+class ObjectSlab {
+	struct SlabHeader {
+		size_t _numaNodeId;
+	};
+
+	//! Offset of the first object, which keeps the header in its own cache line
+	static constexpr size_t _objectsOffset =
+		((sizeof(SlabHeader) + CACHELINE_SIZE - 1) / CACHELINE_SIZE) * CACHELINE_SIZE;
+
+	static_assert(_objectsOffset % alignof(T) == 0, "Misaligned objects in slab");
+
+	static inline SlabHeader *getHeader(T *object)
+	{
+		const uintptr_t mask = ~((uintptr_t) MemoryAllocator::getSlabSize() - 1);
+		return (SlabHeader *) ((uintptr_t) object & mask);
+	}
+
+public:
+	//! \brief Get the number of objects that fit in a slab
+	static inline size_t getCapacity()
+	{
+		assert(MemoryAllocator::getSlabSize() > _objectsOffset + sizeof(T));
+		return (MemoryAllocator::getSlabSize() - _objectsOffset) / sizeof(T);
+	}
+
+	//! \brief Get the slab that holds an object
+	static inline void *getSlab(T *object)
+	{
+		return getHeader(object);
+	}
+
+	//! \brief Get the NUMA node of the memory of an object
+	static inline size_t getNUMANodeId(T *object)
+	{
+		return getHeader(object)->_numaNodeId;
+	}
+
+	//! \brief Allocate a new slab from the global pool of a NUMA node
+	//!
+	//! \param[in] numaNodeId The NUMA node of the slab
+	//!
+	//! \returns The first of the getCapacity() objects of the slab, which
+	//! are not constructed
+	static inline T *create(size_t numaNodeId)
+	{
+		SlabHeader *header = (SlabHeader *) MemoryAllocator::allocSlab(numaNodeId);
+		assert(header != nullptr);
+		header->_numaNodeId = numaNodeId;
+
+		T *objects = (T *) ((char *) header + _objectsOffset);
+		AddressSanitizer::poisonMemoryRegion(objects, getCapacity() * sizeof(T));
+
+		return objects;
+	}
+
+	//! \brief Return a slab with no objects in use to its global pool
+	static inline void destroy(void *slab)
+	{
+		SlabHeader *header = (SlabHeader *) slab;
+		MemoryAllocator::freeSlab(slab, header->_numaNodeId);
+	}
+};
+
+#endif /* __OBJECT_SLAB_HPP__ */
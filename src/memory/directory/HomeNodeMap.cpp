@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include <DataAccessRegion.hpp>
@@ -34,6 +34,7 @@ void HomeNodeMap::insert(
 		[&] (DataAccessRegion missingRegion) -> bool {
 			HomeMapEntry *entry = new HomeMapEntry(missingRegion, homeNode);
 			BaseType::insert(*entry);
+			_index.insert(entry);
 			return true;
 		}
 	);
@@ -45,15 +46,11 @@ HomeNodeMap::HomeNodesArray *HomeNodeMap::find(DataAccessRegion const &region)
 	lock.readLock();
 	HomeNodesArray *ret = new HomeNodesArray();
 
-	processIntersectingAndMissing(
+	_index.processIntersecting(
 		region,
-		[&] (HomeNodeMap::iterator pos) -> bool {
-			HomeMapEntry *entry = &(*pos);
+		[&] (HomeMapEntry *entry) -> bool {
 			ret->push_back(entry);
 			return true;
-		},
-		[&] (__attribute__((unused)) DataAccessRegion missingRegion) -> bool {
-			return true;
 		}
 	);
 
@@ -68,6 +65,7 @@ void HomeNodeMap::erase(DataAccessRegion const &region)
 		region,
 		[&] (HomeNodeMap::iterator pos) -> bool {
 			HomeMapEntry *entry = &(*pos);
+			_index.erase(entry);
 			BaseType::erase(entry);
 			delete entry;
 			return true;
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef HOME_NODE_MAP_HPP
@@ -9,6 +9,7 @@
 
 #include <vector>
 
+#include <FlatRegionIndex.hpp>
 #include <IntrusiveLinearRegionMap.hpp>
 #include <IntrusiveLinearRegionMapImplementation.hpp>
 
@@ -32,12 +33,17 @@ class HomeNodeMap : public
 
 	//! Lock to protect accesses to the Map
 	RWSpinLock lock;
+
+	//! Flat copy of the map for lookups. The home nodes are registered when
+	//! the memory is allocated and looked up for every access, so lookups
+	//! scan this index instead of walking the tree
+	FlatRegionIndex<HomeMapEntry> _index;
 public:
 
 	//! \brief An auxiliary type to return info to callers
 	typedef std::vector<HomeMapEntry *> HomeNodesArray;
 
-	HomeNodeMap() : BaseType()
+	HomeNodeMap() : BaseType(), _index()
 	{
 	}
 
@@ -52,6 +58,7 @@ public:
 				return true;
 			}
 		);
+		_index.clear();
 	}
 
 	//! \brief Insert a region in the map
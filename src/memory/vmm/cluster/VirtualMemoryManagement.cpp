@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include <sys/mman.h>
@@ -158,14 +158,41 @@ static DataAccessRegion findSuitableMemoryRegion()
 	return gap;
 }
 
-VirtualMemoryManagement::VirtualMemoryManagement()
+VirtualMemoryManagement::VirtualMemoryManagement() :
+	_pageSize(HardwareInfo::getPageSize())
 {
+	// The memory.huge_pages variable determines whether the regions are backed by
+	// regular pages, transparent huge pages or explicit huge pages from hugetlbfs
+	ConfigVariable<std::string> hugePagesEnv("memory.huge_pages");
+	ConfigVariable<StringifiedMemorySize> hugePageSizeEnv("memory.huge_page_size");
+	const std::string hugePagesValue = hugePagesEnv.getValue();
+
+	huge_pages_t hugePages = NO_HUGE_PAGES;
+	if (hugePagesValue == "transparent") {
+		hugePages = TRANSPARENT_HUGE_PAGES;
+	} else if (hugePagesValue == "explicit") {
+		hugePages = EXPLICIT_HUGE_PAGES;
+	} else if (hugePagesValue != "none") {
+		FatalErrorHandler::fail("Invalid value for memory.huge_pages: ", hugePagesValue);
+	}
+
+	if (hugePages != NO_HUGE_PAGES) {
+		// Align the regions to huge pages so that the NUMA areas and the
+		// blocks of the memory pools do not share huge pages
+		const size_t hugePageSize = hugePageSizeEnv.getValue();
+		FatalErrorHandler::failIf(
+			hugePageSize < _pageSize || (hugePageSize & (hugePageSize - 1)) != 0,
+			"Invalid value for memory.huge_page_size: ", hugePageSize
+		);
+		_pageSize = hugePageSize;
+	}
+
 	// The cluster.distributed_memory variable determines the total address space to be
 	// used for distributed allocations across the cluster The efault value is 2GB
 	ConfigVariable<StringifiedMemorySize> distribSizeEnv("cluster.distributed_memory");
 	size_t distribSize = distribSizeEnv.getValue();
 	assert(distribSize > 0);
-	distribSize = ROUND_UP(distribSize, HardwareInfo::getPageSize());
+	distribSize = ROUND_UP(distribSize, _pageSize);
 
 	// The cluster.local_memory variable determines the size of the local address space
 	// per cluster node. The default value is the minimum between 2GB and the 5% of the
@@ -178,7 +205,7 @@ VirtualMemoryManagement::VirtualMemoryManagement()
 		localSize = std::min(2UL << 30, totalMemory / 20);
 	}
 	assert(localSize > 0);
-	localSize = ROUND_UP(localSize, HardwareInfo::getPageSize());
+	localSize = ROUND_UP(localSize, _pageSize);
 
 	ConfigVariable<uint64_t> startAddress("cluster.va_start");
 	void *address = (void *) startAddress.getValue();
@@ -188,18 +215,29 @@ VirtualMemoryManagement::VirtualMemoryManagement()
 	if (address == nullptr) {
 		DataAccessRegion gap;
 		gap = findSuitableMemoryRegion();
-		address = gap.getStartAddress();
-		FatalErrorHandler::failIf(gap.getSize() < size, "Cannot allocate virtual memory region");
+
+		// All nodes agree on the gap, so they also agree on the aligned address
+		address = (void *) ROUND_UP((uintptr_t) gap.getStartAddress(), _pageSize);
+		FatalErrorHandler::failIf(
+			(char *) gap.getEndAddress() < (char *) address + size,
+			"Cannot allocate virtual memory region"
+		);
+	} else {
+		FatalErrorHandler::failIf(
+			((uintptr_t) address % _pageSize) != 0,
+			"cluster.va_start must be aligned to the page size (", _pageSize, ")"
+		);
 	}
 
 	assert(_allocations.empty());
-	_allocations.push_back(new VirtualMemoryAllocation(address, size));
+	_allocations.push_back(new VirtualMemoryAllocation(address, size, hugePages, _pageSize));
 
 	setupMemoryLayout(address, distribSize, localSize);
 
 	RuntimeInfo::addEntry("distributed_memory_size", "Size of distributed memory", distribSize);
 	RuntimeInfo::addEntry("local_memorysize", "Size of local memory per node", localSize);
 	RuntimeInfo::addEntry("va_start", "Virtual address space start", (unsigned long)address);
+	RuntimeInfo::addEntry("huge_pages", "Huge page backing of the memory regions", hugePagesValue);
 }
 
 
@@ -253,8 +291,8 @@ void VirtualMemoryManagement::setupMemoryLayout(void *address, size_t distribSiz
 
 	// Divide the address space between the NUMA nodes and the
 	// making sure that all areas have a size that is multiple
-	// of PAGE_SIZE
-	const size_t pageSize = HardwareInfo::getPageSize();
+	// of PAGE_SIZE (or the huge page size if enabled)
+	const size_t pageSize = _pageSize;
 	assert(pageSize > 0);
 	const size_t localPages = localSize / pageSize;
 	assert(localPages > 0);
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2018 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef __VIRTUAL_MEMORY_MANAGEMENT_HPP__
@@ -9,15 +9,36 @@
 
 #include "memory/vmm/VirtualMemoryArea.hpp"
 
+#include <cerrno>
+#include <sys/mman.h>
 #include <vector>
 
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
 class VirtualMemoryManagement {
 public:
+	//! Backing of the mapped regions
+	enum huge_pages_t {
+		//! Regular pages
+		NO_HUGE_PAGES = 0,
+		//! Regular pages, advising the kernel to use transparent huge pages
+		TRANSPARENT_HUGE_PAGES,
+		//! Huge pages from hugetlbfs
+		EXPLICIT_HUGE_PAGES
+	};
+
 	// Subclass allocation; only needed and used here
 	class VirtualMemoryAllocation : public DataAccessRegion
 	{
 	public:
-		VirtualMemoryAllocation(void *address, size_t size) : DataAccessRegion(address, size)
+		VirtualMemoryAllocation(
+			void *address, size_t size,
+			huge_pages_t hugePages = NO_HUGE_PAGES,
+			size_t hugePageSize = 0
+		) :
+			DataAccessRegion(address, size)
 		{
 			FatalErrorHandler::failIf(size == 0, "Virtual memory constructor receive a zero size.");
 
@@ -29,12 +50,44 @@ public:
 			if (address != nullptr) {
 				flags |= MAP_FIXED;
 			}
-			void *ret = mmap(address, size, prot, flags, -1, 0);
+
+			void *ret = MAP_FAILED;
+			if (hugePages == EXPLICIT_HUGE_PAGES) {
+				assert(hugePageSize > 0);
+				assert((size % hugePageSize) == 0);
+
+				// The huge page size is encoded as its base-2 logarithm. The huge pages
+				// are reserved, so that the mapping fails when there are not enough of
+				// them, instead of raising SIGBUS when a page is touched
+				const int hugePageShift = __builtin_ctzl(hugePageSize);
+				const int hugePageFlags = (flags & ~MAP_NORESERVE) | MAP_HUGETLB | (hugePageShift << MAP_HUGE_SHIFT);
+				ret = mmap(address, size, prot, hugePageFlags, -1, 0);
+				if (ret == MAP_FAILED) {
+					FatalErrorHandler::warn(
+						"Could not map ", size, " bytes with huge pages of ", hugePageSize,
+						" bytes (errno: ", errno, "). Falling back to transparent huge pages"
+					);
+					hugePages = TRANSPARENT_HUGE_PAGES;
+				}
+			}
+
+			if (ret == MAP_FAILED) {
+				ret = mmap(address, size, prot, flags, -1, 0);
+			}
 
 			FatalErrorHandler::failIf(ret == MAP_FAILED,
 				"mapping virtual address space failed. errno: ", errno);
 			FatalErrorHandler::failIf(ret != address,
 				"mapping virtual address space couldn't use address hint");
+
+			if (hugePages == TRANSPARENT_HUGE_PAGES) {
+				// This is only a hint; it fails if the kernel has no support
+				if (madvise(ret, size, MADV_HUGEPAGE) != 0) {
+					FatalErrorHandler::warn(
+						"Transparent huge pages are not available (errno: ", errno, ")"
+					);
+				}
+			}
 		}
 
 		~VirtualMemoryAllocation()
@@ -54,6 +107,10 @@ private:
 	//! addresses for generic allocations
 	VirtualMemoryArea *_genericVMA;
 
+	//! granularity of the memory layout; the huge page size if the regions
+	//! are backed by huge pages, and the system page size otherwise
+	size_t _pageSize;
+
 	//! Setting up the memory layout
 	void setupMemoryLayout(void *address, size_t distribSize, size_t localSize);
 
@@ -157,6 +214,16 @@ public:
 		return isDistributedRegion(region) || isLocalRegion(region);
 	}
 
+	//! \brief Get the granularity of the mapped regions
+	//!
+	//! Blocks that are multiple of this size keep the alignment of the
+	//! underlying pages, so that they can be bound to NUMA nodes
+	static inline size_t getPageSize()
+	{
+		assert(_singleton != nullptr);
+		return _singleton->_pageSize;
+	}
+
 	static inline std::vector<VirtualMemoryManagement::VirtualMemoryAllocation *> getAllocations()
 	{
 		assert(_singleton != nullptr);
@@ -114,6 +114,12 @@ public:
 		return _localNUMAVMA.size();
 	}
 
+	//! \brief Get the granularity of the mapped regions
+	static inline size_t getPageSize()
+	{
+		return HardwareInfo::getPageSize();
+	}
+
 	static constexpr inline bool isDistributedRegion(const DataAccessRegion&)
 	{
 		return false;
@@ -6,6 +6,7 @@
 
 #include <config.h>
 #include <fstream>
+#include <iomanip>
 
 #include "CPUMonitor.hpp"
 #include "Monitoring.hpp"
@@ -24,6 +25,8 @@
 #include "executors/threads/CPU.hpp"
 #include "executors/threads/WorkerThread.hpp"
 
+#include <MemoryAllocator.hpp>
+
 
 ConfigVariable<bool> Monitoring::_enabled("monitoring.enabled");
 ConfigVariable<bool> Monitoring::_verbose("monitoring.verbose");
@@ -373,6 +376,10 @@ void Monitoring::displayStatistics()
 		RuntimeStateMonitor::displayStatistics(outputStream);
 	}
 
+	if (MemoryAllocator::hasUsageStatistics()) {
+		displayMemoryStatistics(outputStream);
+	}
+
 	if (output.is_open()) {
 		output << outputStream.str();
 		output.close();
@@ -381,6 +388,23 @@ void Monitoring::displayStatistics()
 	}
 }
 
+void Monitoring::displayMemoryStatistics(std::stringstream &stream)
+{
+	size_t usedBytes, cachedBytes, obtainedBytes;
+	MemoryAllocator::getMemoryStatistics(usedBytes, cachedBytes, obtainedBytes);
+
+	const double MB = 1024.0 * 1024.0;
+
+	stream << std::left << std::fixed << std::setprecision(2) << "\n";
+	stream << "+-----------------------------+\n";
+	stream << "|      MEMORY STATISTICS      |\n";
+	stream << "+-----------------------------+\n";
+	stream << std::setw(20) << "In use" << std::right << std::setw(10) << (usedBytes / MB) << std::left << " MB\n";
+	stream << std::setw(20) << "Cached" << std::right << std::setw(10) << (cachedBytes / MB) << std::left << " MB\n";
+	stream << std::setw(20) << "Obtained from OS" << std::right << std::setw(10) << (obtainedBytes / MB) << std::left << " MB\n";
+	stream << "+-----------------------------+\n\n";
+}
+
 void Monitoring::loadMonitoringWisdom()
 {
 	// Create a representation of the system file as a JsonFile
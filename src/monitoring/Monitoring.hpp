@@ -7,6 +7,7 @@
 #ifndef MONITORING_HPP
 #define MONITORING_HPP
 
+#include <sstream>
 #include <sys/types.h>
 
 #include "MonitoringSupport.hpp"
@@ -64,6 +65,9 @@ private:
 	//! \brief Display monitoring statistics
 	static void displayStatistics();
 
+	//! \brief Display the usage statistics of the memory allocator
+	static void displayMemoryStatistics(std::stringstream &stream);
+
 	//! \brief Try to load previous monitoring data into accumulators
 	static void loadMonitoringWisdom();
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASKTYPE_STATISTICS_HPP
@@ -15,6 +15,7 @@
 #endif
 
 #include <atomic>
+#include <cassert>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics.hpp>
 #include <boost/accumulators/statistics/rolling_mean.hpp>
@@ -86,6 +87,10 @@ private:
 	//! Spinlock to ensure atomic access within the previous accumulators
 	SpinLock _timingAccumulatorLock;
 
+	//! Smoothed time per iteration of the taskfor chunks of this tasktype in
+	//! nanoseconds, or zero if unknown. It is kept even if Monitoring is disabled
+	std::atomic<double> _chunkIterationTime;
+
 	//    HARDWARE COUNTER METRICS    //
 
 	//! A vector of hardware counter accumulators
@@ -118,6 +123,7 @@ public:
 		_timingAccuracyAccumulator(),
 		_accumulatedTimeAccumulator(),
 		_timingAccumulatorLock(),
+		_chunkIterationTime(0.0),
 		_counterAccumulators(HWCounters::HWC_TOTAL_NUM_EVENTS),
 		_normalizedCounterAccumulators(
 			HWCounters::HWC_TOTAL_NUM_EVENTS,
@@ -269,6 +275,29 @@ public:
 	//! \param[in] cost The task's computational costs
 	double getTimingPrediction(size_t cost);
 
+	//! \brief Account the execution time of a taskfor chunk
+	//!
+	//! \param[in] iterations The number of iterations of the chunk
+	//! \param[in] time The execution time of the chunk in nanoseconds
+	inline void insertChunkTime(size_t iterations, size_t time)
+	{
+		assert(iterations > 0);
+
+		const double sample = (double) time / (double) iterations;
+		double average = _chunkIterationTime.load(std::memory_order_relaxed);
+		double updated;
+		do {
+			updated = (average == 0.0) ? sample : 0.75 * average + 0.25 * sample;
+		} while (!_chunkIterationTime.compare_exchange_weak(average, updated, std::memory_order_relaxed));
+	}
+
+	//! \brief Get the smoothed time per iteration of the taskfor chunks of
+	//! this tasktype in nanoseconds, or zero if unknown
+	inline double getChunkIterationTime() const
+	{
+		return _chunkIterationTime.load(std::memory_order_relaxed);
+	}
+
 	//    HARDWARE COUNTER METRICS    //
 
 	//! \brief Insert a metric into the corresponding accumulator
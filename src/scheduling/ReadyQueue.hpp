@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef READY_QUEUE_HPP
@@ -21,7 +21,10 @@ enum ReadyTaskHint {
 	SIBLING_TASK_HINT,
 	BUSY_COMPUTE_PLACE_TASK_HINT,
 	UNBLOCKED_TASK_HINT,
-	DEADLINE_TASK_HINT
+	DEADLINE_TASK_HINT,
+	//! The task has received the ownership of a resource from a task
+	//! of the compute place, such as a user mutex
+	HANDOFF_TASK_HINT
 };
 
 //! \brief Interface that ready queues must implement
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef SCHEDULER_HPP
@@ -76,6 +76,16 @@ public:
 		return _instance->isServingTasks();
 	}
 
+	//! \brief Get an estimation of the number of host tasks that are ready
+	//!
+	//! The count does not include the tasks that are being added to the
+	//! scheduler nor the immediate successors, and it is computed without
+	//! locking the scheduler
+	static inline size_t getNumReadyTasks()
+	{
+		return _instance->getNumReadyTasks();
+	}
+
 	//! \brief Check whether task priority is considered
 	static inline bool isPriorityEnabled()
 	{
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef SCHEDULER_INTERFACE_HPP
@@ -66,6 +66,16 @@ public:
 	{
 		assert(taskType != nanos6_cluster_device);
 
+#ifdef EXTRAE_ENABLED
+		if (!_mainFirstRunCompleted) {
+			// Add them one by one so that the main task is intercepted
+			for (size_t t = 0; t < numTasks; ++t) {
+				addReadyTask(tasks[t], computePlace, hint);
+			}
+			return;
+		}
+#endif
+
 		if (taskType == nanos6_host_device) {
 			_hostScheduler->addReadyTasks(tasks, numTasks, computePlace, hint);
 		} else {
@@ -106,6 +116,11 @@ public:
 		return _hostScheduler->isServingTasks();
 	}
 
+	virtual inline size_t getNumReadyTasks() const
+	{
+		return _hostScheduler->getNumReadyTasks();
+	}
+
 	virtual std::string getName() const = 0;
 
 	//! \brief Check whether task priority is considered
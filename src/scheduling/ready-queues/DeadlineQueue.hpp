@@ -7,47 +7,182 @@
 #ifndef DEADLINE_QUEUE_HPP
 #define DEADLINE_QUEUE_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
 #include "scheduling/ReadyQueue.hpp"
 #include "support/Chrono.hpp"
 #include "support/Containers.hpp"
 #include "tasks/Task.hpp"
 
 //! This kind of ready queue supports deadlines
+//!
+//! The tasks are kept in a hierarchical timer wheel. The time is divided
+//! in ticks and each level of the wheel has a slot per tick of the level,
+//! which spans as many ticks as the whole previous level. A task is placed
+//! in the lowest level that can hold its deadline, and it is moved to the
+//! lower levels as the time advances. Thus, adding a task is O(1) and the
+//! tasks expire with the granularity of a tick, never before their deadline
 class DeadlineQueue : public ReadyQueue {
-	//! Deadline compare function
-	struct DeadlineCompare {
-		bool operator() (const Task *left, const Task *right) const
-		{
-			if (left->getDeadline() != right->getDeadline()) {
-				return (left->getDeadline() < right->getDeadline());
+	typedef uint64_t tick_t;
+	typedef Container::vector<Task *> slot_t;
+	typedef Container::deque<Task *> expired_tasks_t;
+
+	//! Each tick lasts 2^TICK_SHIFT microseconds
+	static constexpr size_t TICK_SHIFT = 4;
+
+	//! Each level has 2^SLOT_SHIFT slots
+	static constexpr size_t SLOT_SHIFT = 6;
+	static constexpr size_t NUM_SLOTS = (1 << SLOT_SHIFT);
+	static constexpr size_t NUM_LEVELS = 4;
+
+	//! The slots of all levels. Deadlines beyond the range of the last
+	//! level are kept in its slots and checked again each time they are
+	//! visited
+	slot_t _slots[NUM_LEVELS][NUM_SLOTS];
+
+	//! Tasks whose deadline has been satisfied
+	expired_tasks_t _expiredTasks;
+
+	//! The number of expired tasks. Only modified with the scheduler lock
+	//! held, but atomic so that it can be read without the lock
+	std::atomic<size_t> _numExpiredTasks;
+
+	//! Tasks taken from the visited slots, kept to reuse its storage
+	slot_t _pendingTasks;
+
+	//! The number of tasks in the wheel, excluding the expired ones
+	size_t _numTasks;
+
+	//! The first tick that has not been processed yet
+	tick_t _currentTick;
+
+	//! No task in the wheel expires before this tick
+	tick_t _nextExpirationTick;
+
+	//! The cached current time point (may be stale)
+	Task::deadline_t _now;
+
+	static inline tick_t getTick(Task::deadline_t time)
+	{
+		return (time >> TICK_SHIFT);
+	}
+
+	//! \brief Get the first tick in which a deadline is satisfied
+	static inline tick_t getExpirationTick(const Task *task)
+	{
+		const Task::deadline_t deadline = task->getDeadline();
+		return getTick(deadline) + ((deadline & ((1 << TICK_SHIFT) - 1)) ? 1 : 0);
+	}
+
+	static inline tick_t getBlock(tick_t tick, size_t level)
+	{
+		return (tick >> (level * SLOT_SHIFT));
+	}
+
+	//! \brief Place a task in the wheel or in the expired tasks
+	inline void insert(Task *task)
+	{
+		const tick_t tick = getExpirationTick(task);
+		if (tick < _currentTick) {
+			_expiredTasks.push_back(task);
+			updateNumExpiredTasks(1);
+			return;
+		}
+
+		size_t level = 0;
+		while (level < NUM_LEVELS - 1
+			&& getBlock(tick, level) - getBlock(_currentTick, level) >= NUM_SLOTS
+		) {
+			level++;
+		}
+
+		_slots[level][getBlock(tick, level) % NUM_SLOTS].push_back(task);
+		_nextExpirationTick = std::min(_nextExpirationTick, tick);
+		_numTasks++;
+	}
+
+	inline void updateNumExpiredTasks(long delta)
+	{
+		_numExpiredTasks.store(_numExpiredTasks.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+	}
+
+	//! \brief Process the ticks up to the given one, both included
+	//!
+	//! The tasks of the visited slots either expire or are placed again,
+	//! which moves them to the lower levels
+	void advance(tick_t nowTick)
+	{
+		assert(nowTick >= _currentTick);
+
+		assert(_pendingTasks.empty());
+		for (size_t level = 0; level < NUM_LEVELS; level++) {
+			const tick_t firstBlock = getBlock(_currentTick, level);
+			const tick_t lastBlock = std::min(getBlock(nowTick, level), firstBlock + NUM_SLOTS - 1);
+
+			for (tick_t block = firstBlock; block <= lastBlock; block++) {
+				slot_t &slot = _slots[level][block % NUM_SLOTS];
+				if (!slot.empty()) {
+					_numTasks -= slot.size();
+					_pendingTasks.insert(_pendingTasks.end(), slot.begin(), slot.end());
+					slot.clear();
+				}
 			}
-			return (left < right);
 		}
-	};
 
-	//! Set of deadline tasks ordered by their task deadline
-	//! in ascending order. Tasks with the lowest deadline
-	//! are stored at the first positions. It also allows
-	//! different tasks to share the same deadline
-	typedef Container::set<Task *, DeadlineCompare> deadline_set_t;
+		_currentTick = nowTick + 1;
 
-	//! The ordered set of deadline tasks
-	deadline_set_t _deadlineTasks;
+		// Tasks are inserted in FIFO order among the ones that expire together
+		for (Task *task : _pendingTasks) {
+			insert(task);
+		}
+		_pendingTasks.clear();
 
-	//! The cached current time point (may be stale)
-	mutable Task::deadline_t _now;
+		updateNextExpiration();
+	}
+
+	//! \brief Compute a lower bound of the first tick in which a task expires
+	void updateNextExpiration()
+	{
+		_nextExpirationTick = UINT64_MAX;
+		if (_numTasks == 0)
+			return;
+
+		// The tasks that stay in the higher levels may expire before the ones
+		// placed afterwards in the lower levels, so all levels are checked
+		for (size_t level = 0; level < NUM_LEVELS; level++) {
+			const tick_t firstBlock = getBlock(_currentTick, level);
+			for (tick_t block = firstBlock; block < firstBlock + NUM_SLOTS; block++) {
+				if (!_slots[level][block % NUM_SLOTS].empty()) {
+					// The first tick of the block, unless it has already started
+					tick_t tick = std::max(block << (level * SLOT_SHIFT), _currentTick);
+					_nextExpirationTick = std::min(_nextExpirationTick, tick);
+					break;
+				}
+			}
+		}
+		assert(_nextExpirationTick != UINT64_MAX);
+	}
 
 public:
 	inline DeadlineQueue(SchedulingPolicy policy) :
 		ReadyQueue(policy),
-		_deadlineTasks(),
+		_expiredTasks(),
+		_numExpiredTasks(0),
+		_pendingTasks(),
+		_numTasks(0),
 		_now(Chrono::now<Task::deadline_t>())
 	{
+		_currentTick = getTick(_now);
+		_nextExpirationTick = UINT64_MAX;
 	}
 
 	inline ~DeadlineQueue()
 	{
-		assert(_deadlineTasks.empty());
+		assert(_numTasks == 0);
+		assert(_expiredTasks.empty());
 	}
 
 	//! \brief Add ready task with deadline
@@ -62,12 +197,7 @@ public:
 	{
 		assert(task->hasDeadline());
 
-#ifndef NDEBUG
-		auto res = _deadlineTasks.insert(task);
-		assert(res.second);
-#else
-		_deadlineTasks.insert(task);
-#endif
+		insert(task);
 	}
 
 	//! \brief Get a ready task with the deadline satisfied
@@ -75,28 +205,33 @@ public:
 	//! \param computePlace The current compute place
 	inline Task *getReadyTask(ComputePlace *)
 	{
-		if (_deadlineTasks.empty())
-			return nullptr;
+		if (_expiredTasks.empty()) {
+			if (_numTasks == 0)
+				return nullptr;
 
-		auto it = _deadlineTasks.begin();
-		assert(it != _deadlineTasks.end());
+			// Nothing expires before the next expiration tick, so the
+			// wheel is only visited when a task can actually expire.
+			// First check using the cached current time and then using
+			// the updated current time
+			tick_t nowTick = getTick(_now);
+			if (nowTick < _nextExpirationTick) {
+				_now = Chrono::now<Task::deadline_t>();
+				nowTick = getTick(_now);
+				if (nowTick < _nextExpirationTick)
+					return nullptr;
+			}
 
-		Task *task = *it;
+			advance(nowTick);
+			if (_expiredTasks.empty())
+				return nullptr;
+		}
+
+		Task *task = _expiredTasks.front();
 		assert(task != nullptr);
 
-		// First check using the cached current time
-		// and then using the updated current time
-		if (task->getDeadline() <= _now) {
-			_deadlineTasks.erase(it);
-			return task;
-		} else {
-			_now = Chrono::now<Task::deadline_t>();
-			if (task->getDeadline() < _now) {
-				_deadlineTasks.erase(it);
-				return task;
-			}
-		}
-		return nullptr;
+		_expiredTasks.pop_front();
+		updateNumExpiredTasks(-1);
+		return task;
 	}
 
 	inline Task *tryReadyTask(ComputePlace *, Task *)
@@ -106,21 +241,13 @@ public:
 	}
 
 	//! \brief Get the number of available deadline tasks
+	//!
+	//! Only the tasks that have already been found expired are counted, so
+	//! it does not need the scheduler lock. The tasks of the wheel whose
+	//! deadline has passed are counted once the queue is visited again
 	inline size_t getNumReadyTasks() const
 	{
-		if (_deadlineTasks.empty())
-			return 0;
-
-		_now = Chrono::now<Task::deadline_t>();
-
-		size_t numReady = 0;
-		for (Task *task : _deadlineTasks) {
-			if (task->getDeadline() > _now)
-				break;
-
-			++numReady;
-		}
-		return numReady;
+		return _numExpiredTasks.load(std::memory_order_relaxed);
 	}
 
 	inline long getNextTaskPriority()
@@ -0,0 +1,118 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef IMMEDIATE_SUCCESSOR_QUEUE_HPP
+#define IMMEDIATE_SUCCESSOR_QUEUE_HPP
+
+#include <cassert>
+
+#include "support/Containers.hpp"
+
+class Task;
+
+//! \brief A bounded queue of the immediate successors of a compute place
+//!
+//! The newest successor is the one that most likely finds its data in the
+//! cache, so it is the first one to be executed by the owner of the queue.
+//! Other compute places take the oldest ones. This class is not thread-safe
+class ImmediateSuccessorQueue {
+	typedef Container::vector<Task *> slots_t;
+
+	slots_t _slots;
+
+	//! Position of the oldest task
+	size_t _head;
+
+	//! Number of tasks in the queue
+	size_t _size;
+
+	inline size_t getSlot(size_t position) const
+	{
+		return (_head + position) % _slots.size();
+	}
+
+public:
+	ImmediateSuccessorQueue(size_t capacity = 1) :
+		_slots(capacity, nullptr),
+		_head(0),
+		_size(0)
+	{
+		assert(capacity > 0);
+	}
+
+	inline bool empty() const
+	{
+		return (_size == 0);
+	}
+
+	inline bool full() const
+	{
+		return (_size == _slots.size());
+	}
+
+	//! \brief Add the newest task
+	//!
+	//! \param[in] task The task to add
+	//!
+	//! \returns The oldest task if the queue was full and it had to be
+	//! evicted, or nullptr otherwise
+	inline Task *pushNewest(Task *task)
+	{
+		assert(task != nullptr);
+
+		Task *evicted = nullptr;
+		if (full()) {
+			evicted = popOldest();
+		}
+
+		_slots[getSlot(_size)] = task;
+		_size++;
+
+		return evicted;
+	}
+
+	//! \brief Add a task behind the ones that are already in the queue
+	inline void pushOldest(Task *task)
+	{
+		assert(task != nullptr);
+		assert(!full());
+
+		_head = (_head + _slots.size() - 1) % _slots.size();
+		_slots[_head] = task;
+		_size++;
+	}
+
+	inline Task *popNewest()
+	{
+		if (empty())
+			return nullptr;
+
+		_size--;
+		const size_t slot = getSlot(_size);
+		Task *task = _slots[slot];
+		_slots[slot] = nullptr;
+
+		assert(task != nullptr);
+		return task;
+	}
+
+	inline Task *popOldest()
+	{
+		if (empty())
+			return nullptr;
+
+		Task *task = _slots[_head];
+		_slots[_head] = nullptr;
+		_head = getSlot(1);
+		_size--;
+
+		assert(task != nullptr);
+		return task;
+	}
+};
+
+
+#endif // IMMEDIATE_SUCCESSOR_QUEUE_HPP
@@ -1,12 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef READY_QUEUE_DEQUE_HPP
 #define READY_QUEUE_DEQUE_HPP
 
+#include <atomic>
+
 #include "memory/numa/NUMAManager.hpp"
 #include "scheduling/ReadyQueue.hpp"
 #include "support/Containers.hpp"
@@ -16,7 +18,14 @@ class ReadyQueueDeque : public ReadyQueue {
 
 	ready_queue_t _readyDeque;
 
-	size_t _numReadyTasks;
+	//! Only modified with the scheduler lock held, but atomic so that it
+	//! can be read without the lock
+	std::atomic<size_t> _numReadyTasks;
+
+	inline void updateNumReadyTasks(long delta)
+	{
+		_numReadyTasks.store(_numReadyTasks.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+	}
 
 public:
 	ReadyQueueDeque(SchedulingPolicy policy) :
@@ -39,7 +48,7 @@ public:
 			_readyDeque.push_back(task);
 		}
 
-		++_numReadyTasks;
+		updateNumReadyTasks(1);
 	}
 
 	inline Task *getReadyTask(ComputePlace *)
@@ -53,7 +62,7 @@ public:
 
 		_readyDeque.pop_front();
 
-		--_numReadyTasks;
+		updateNumReadyTasks(-1);
 
 		return result;
 	}
@@ -70,15 +79,16 @@ public:
 		if (result == reserved) {
 			_readyDeque.pop_front();
 
-			--_numReadyTasks;
+			updateNumReadyTasks(-1);
 		}
 
 		return result;
 	}
 
+	//! \brief Get the number of ready tasks, which does not need the scheduler lock
 	inline size_t getNumReadyTasks() const
 	{
-		return _numReadyTasks;
+		return _numReadyTasks.load(std::memory_order_relaxed);
 	}
 
 	inline long getNextTaskPriority()
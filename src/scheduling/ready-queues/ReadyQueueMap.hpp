@@ -1,12 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef READY_QUEUE_MAP_HPP
 #define READY_QUEUE_MAP_HPP
 
+#include <atomic>
+
 #include "memory/numa/NUMAManager.hpp"
 #include "scheduling/ReadyQueue.hpp"
 #include "support/Containers.hpp"
@@ -19,7 +21,14 @@ class ReadyQueueMap : public ReadyQueue {
 
 	ready_map_t _readyMap;
 
-	size_t _numReadyTasks;
+	//! Only modified with the scheduler lock held, but atomic so that it
+	//! can be read without the lock
+	std::atomic<size_t> _numReadyTasks;
+
+	inline void updateNumReadyTasks(long delta)
+	{
+		_numReadyTasks.store(_numReadyTasks.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+	}
 
 public:
 	ReadyQueueMap(SchedulingPolicy policy) :
@@ -53,7 +62,7 @@ public:
 		}
 
 
-		++_numReadyTasks;
+		updateNumReadyTasks(1);
 	}
 
 	inline Task *getReadyTask(ComputePlace *)
@@ -72,7 +81,7 @@ public:
 
 				it->second.pop_front();
 
-				--_numReadyTasks;
+				updateNumReadyTasks(-1);
 
 				return result;
 			}
@@ -116,7 +125,7 @@ public:
 				if (reserved == result) {
 					it->second.pop_front();
 
-					--_numReadyTasks;
+					updateNumReadyTasks(-1);
 				}
 
 				return result;
@@ -129,9 +138,10 @@ public:
 		return nullptr;
 	}
 
+	//! \brief Get the number of ready tasks, which does not need the scheduler lock
 	inline size_t getNumReadyTasks() const
 	{
-		return _numReadyTasks;
+		return _numReadyTasks.load(std::memory_order_relaxed);
 	}
 
 };
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "HostUnsyncScheduler.hpp"
@@ -52,7 +52,9 @@ retry:
 			if (priority >= topPriority) {
 				groupTaskfor->notifyCollaboratorHasStarted();
 				bool remove = false;
-				const int myChunk = groupTaskfor->getNextChunk(cpu, &remove);
+				size_t lowerBound = 0;
+				size_t upperBound = 0;
+				const int myChunk = groupTaskfor->getNextChunk(cpu, lowerBound, upperBound, &remove);
 				if (remove) {
 					_groupSlots[groupId] = nullptr;
 					groupTaskfor->removedFromScheduler();
@@ -60,7 +62,7 @@ retry:
 
 				Taskfor *taskfor = computePlace->getPreallocatedTaskfor();
 				// We are setting the chunk that the collaborator will execute in the preallocatedTaskfor
-				taskfor->setChunk(myChunk);
+				taskfor->setChunk(myChunk, lowerBound, upperBound);
 				return groupTaskfor;
 			} else {
 				// Interrupt this taskfor for a higher priority task (may itself be
@@ -110,9 +112,8 @@ retry:
 		// 4. Try to get work from my immediateSuccessorTasks
 		const long cpuId = computePlace->getIndex();
 
-		if (result == nullptr && _immediateSuccessorTasks[cpuId] != nullptr) {
-			result = _immediateSuccessorTasks[cpuId];
-			_immediateSuccessorTasks[cpuId] = nullptr;
+		if (result == nullptr) {
+			result = getImmediateSuccessor(cpuId);
 		}
 	}
 
@@ -121,16 +122,11 @@ retry:
 		result = regularGetReadyTask(computePlace);
 	}
 
-	// 6. Try to get work from other immediateSuccessorTasks
+	// 6. Try to get work from other immediateSuccessorTasks, starting
+	// from the CPUs that share a cache with this one
 	if (result == nullptr && _enableImmediateSuccessor) {
-		for (size_t i = 0; i < _immediateSuccessorTasks.size(); i++) {
-			if (_immediateSuccessorTasks[i] != nullptr) {
-				result = _immediateSuccessorTasks[i];
-				assert(!result->isTaskfor());
-				_immediateSuccessorTasks[i] = nullptr;
-				break;
-			}
-		}
+		result = stealImmediateSuccessor(computePlace->getIndex());
+		assert(result == nullptr || !result->isTaskfor());
 	}
 
 	// 7. Try to get work from other immediateSuccessorTasksfors
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef HOST_UNSYNC_SCHEDULER_HPP
@@ -30,6 +30,7 @@ public:
 
 		if (enableImmediateSuccessor) {
 			_immediateSuccessorTaskfors = immediate_successor_tasks_t(groups*2, nullptr);
+			initializeCacheSiblings();
 		}
 
 		_deadlineTasks = new DeadlineQueue(policy);
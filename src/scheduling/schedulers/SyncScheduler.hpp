@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef SYNC_SCHEDULER_HPP
@@ -116,6 +116,12 @@ public:
 		return _servingTasks.load(std::memory_order_relaxed);
 	}
 
+	//! \brief Get an estimation of the number of ready tasks
+	inline size_t getNumReadyTasks() const
+	{
+		return _scheduler->getNumReadyTasks();
+	}
+
 	inline void addReadyTask(Task *task, ComputePlace *computePlace, ReadyTaskHint hint)
 	{
 		// TODO: Allow adding multiple tasks in the future
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "UnsyncScheduler.hpp"
@@ -9,6 +9,8 @@
 #include "executors/threads/CPUManager.hpp"
 
 
+ConfigVariable<size_t> UnsyncScheduler::_immediateSuccessorDepth("scheduler.immediate_successor_depth");
+
 UnsyncScheduler::UnsyncScheduler(
 	SchedulingPolicy,
 	bool enablePriority,
@@ -22,7 +24,11 @@ UnsyncScheduler::UnsyncScheduler(
 	_enablePriority(enablePriority)
 {
 	if (enableImmediateSuccessor) {
-		_immediateSuccessorTasks = immediate_successor_tasks_t(CPUManager::getTotalCPUs(), nullptr);
+		const size_t depth = _immediateSuccessorDepth.getValue();
+		FatalErrorHandler::failIf(depth == 0, "The immediate successor depth must be at least 1");
+
+		_immediateSuccessorTasks = immediate_successor_queues_t(
+			CPUManager::getTotalCPUs(), ImmediateSuccessorQueue(depth));
 	}
 }
 
@@ -39,6 +45,76 @@ UnsyncScheduler::~UnsyncScheduler()
 	MemoryAllocator::free(_queues, _numQueues * sizeof(ReadyQueue *));
 }
 
+void UnsyncScheduler::initializeCacheSiblings()
+{
+	const std::vector<CPU *> &cpus = CPUManager::getCPUListReference();
+	_cacheSiblings = cache_siblings_t(cpus.size());
+
+	for (size_t i = 0; i < cpus.size(); i++) {
+		L2Cache *l2Cache = cpus[i]->getL2Cache();
+		L3Cache *l3Cache = cpus[i]->getL3Cache();
+
+		for (size_t j = 0; j < cpus.size(); j++) {
+			if (j != i && l2Cache != nullptr && cpus[j]->getL2Cache() == l2Cache) {
+				_cacheSiblings[i].push_back(j);
+			}
+		}
+
+		for (size_t j = 0; j < cpus.size(); j++) {
+			if (j != i && l3Cache != nullptr && cpus[j]->getL3Cache() == l3Cache
+				&& (l2Cache == nullptr || cpus[j]->getL2Cache() != l2Cache)
+			) {
+				_cacheSiblings[i].push_back(j);
+			}
+		}
+	}
+}
+
+void UnsyncScheduler::addImmediateSuccessor(Task *task, size_t computePlaceId)
+{
+	assert(task != nullptr);
+	assert(!task->isTaskfor());
+	assert(computePlaceId < _immediateSuccessorTasks.size());
+
+	Task *evicted = _immediateSuccessorTasks[computePlaceId].pushNewest(task);
+	if (evicted == nullptr)
+		return;
+
+	// The evicted task may still find its data in a shared cache. It is added
+	// behind the successors of the sibling, which are more likely to be hot
+	if (computePlaceId < _cacheSiblings.size()) {
+		for (size_t sibling : _cacheSiblings[computePlaceId]) {
+			if (!_immediateSuccessorTasks[sibling].full()) {
+				_immediateSuccessorTasks[sibling].pushOldest(evicted);
+				return;
+			}
+		}
+	}
+
+	regularAddReadyTask(evicted, false);
+}
+
+Task *UnsyncScheduler::stealImmediateSuccessor(size_t computePlaceId)
+{
+	Task *result = nullptr;
+
+	if (computePlaceId < _cacheSiblings.size()) {
+		for (size_t sibling : _cacheSiblings[computePlaceId]) {
+			result = _immediateSuccessorTasks[sibling].popOldest();
+			if (result != nullptr)
+				return result;
+		}
+	}
+
+	for (size_t i = 0; i < _immediateSuccessorTasks.size(); i++) {
+		result = _immediateSuccessorTasks[i].popOldest();
+		if (result != nullptr)
+			break;
+	}
+
+	return result;
+}
+
 void UnsyncScheduler::regularAddReadyTask(Task *task, bool unblocked)
 {
 	uint64_t NUMAid = task->getNUMAHint();
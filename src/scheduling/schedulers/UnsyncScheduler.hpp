@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef UNSYNC_SCHEDULER_HPP
@@ -14,17 +14,28 @@
 #include "lowlevel/FatalErrorHandler.hpp"
 #include "scheduling/ReadyQueue.hpp"
 #include "scheduling/ready-queues/DeadlineQueue.hpp"
+#include "scheduling/ready-queues/ImmediateSuccessorQueue.hpp"
 #include "support/Containers.hpp"
+#include "support/config/ConfigVariable.hpp"
 #include "tasks/Task.hpp"
 
 
 class UnsyncScheduler {
 protected:
 	typedef Container::vector<Task *> immediate_successor_tasks_t;
+	typedef Container::vector<ImmediateSuccessorQueue> immediate_successor_queues_t;
+	typedef Container::vector<Container::vector<size_t>> cache_siblings_t;
 
-	immediate_successor_tasks_t _immediateSuccessorTasks;
+	//! The maximum number of immediate successors of each compute place
+	static ConfigVariable<size_t> _immediateSuccessorDepth;
+
+	immediate_successor_queues_t _immediateSuccessorTasks;
 	immediate_successor_tasks_t _immediateSuccessorTaskfors;
 
+	//! The CPUs that share a cache with each CPU, the ones sharing the L2
+	//! first. Empty unless the scheduler initializes the cache topology
+	cache_siblings_t _cacheSiblings;
+
 	ReadyQueue **_queues;
 	size_t _numQueues;
 
@@ -66,16 +77,22 @@ public:
 			return;
 		}
 
+		if (hint == HANDOFF_TASK_HINT) {
+			// The task becomes an immediate successor of the compute place
+			// if possible. Otherwise it goes first, as an unblocked task
+			if (_enableImmediateSuccessor && computePlace != nullptr && !task->isTaskfor()) {
+				addImmediateSuccessor(task, computePlace->getIndex());
+			} else {
+				regularAddReadyTask(task, true);
+			}
+			return;
+		}
+
 		if (_enableImmediateSuccessor) {
 			if (computePlace != nullptr && hint == SIBLING_TASK_HINT) {
 				size_t immediateSuccessorId = computePlace->getIndex();
 				if (!task->isTaskfor()) {
-					Task *currentIS = _immediateSuccessorTasks[immediateSuccessorId];
-					if (currentIS != nullptr) {
-						assert(!currentIS->isTaskfor());
-						regularAddReadyTask(currentIS, false);
-					}
-					_immediateSuccessorTasks[immediateSuccessorId] = task;
+					addImmediateSuccessor(task, immediateSuccessorId);
 				} else {
 					// Multiply by 2 because there are 2 slots per group
 					immediateSuccessorId = ((CPU *)computePlace)->getGroupId()*2;
@@ -104,7 +121,53 @@ public:
 	//! \returns a ready task or nullptr
 	virtual Task *getReadyTask(ComputePlace *computePlace) = 0;
 
+	//! \brief Get an estimation of the number of tasks in the ready queues
+	//!
+	//! It may be called without the scheduler lock, since each queue only
+	//! reads its atomic counter of ready tasks. The counters are read one
+	//! after the other while other threads change them, so the sum may not
+	//! match any state the scheduler has actually been in
+	inline size_t getNumReadyTasks() const
+	{
+		size_t numReadyTasks = 0;
+		for (size_t q = 0; q < _numQueues; q++) {
+			if (_queues[q] != nullptr) {
+				numReadyTasks += _queues[q]->getNumReadyTasks();
+			}
+		}
+		return numReadyTasks;
+	}
+
 protected:
+	//! \brief Compute the CPUs that share an L2 or L3 cache with each CPU
+	void initializeCacheSiblings();
+
+	//! \brief Add an immediate successor to a compute place
+	//!
+	//! If the queue of the compute place is full, its oldest successor is
+	//! offered to the CPUs that share a cache with it, and it is added to the
+	//! NUMA queues if none of them has room for it
+	//!
+	//! \param[in] task the successor task
+	//! \param[in] computePlaceId the index of the compute place
+	void addImmediateSuccessor(Task *task, size_t computePlaceId);
+
+	//! \brief Take the newest immediate successor of a compute place
+	inline Task *getImmediateSuccessor(size_t computePlaceId)
+	{
+		assert(computePlaceId < _immediateSuccessorTasks.size());
+
+		return _immediateSuccessorTasks[computePlaceId].popNewest();
+	}
+
+	//! \brief Take the oldest immediate successor of another compute place,
+	//! trying the ones that share a cache with the given one first
+	//!
+	//! \param[in] computePlaceId the index of the compute place asking for work
+	//!
+	//! \returns an immediate successor or nullptr
+	Task *stealImmediateSuccessor(size_t computePlaceId);
+
 	//! \brief Add ready task considering NUMA queues
 	//!
 	//! \param[in] task the ready task to add
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CLUSTER_SCHEDULER_INTERFACE_HPP
@@ -207,6 +207,21 @@ public:
 		}
 	};
 
+	//! Every task needs its own cluster scheduling decision, so the tasks
+	//! are not passed to the local schedulers as a batch
+	void addReadyTasks(
+		__attribute__((unused)) nanos6_device_t taskType,
+		Task *tasks[],
+		const size_t numTasks,
+		ComputePlace *computePlace,
+		ReadyTaskHint hint
+	) override {
+		for (size_t t = 0; t < numTasks; ++t) {
+			assert(tasks[t]->getDeviceType() == taskType);
+			addReadyTask(tasks[t], computePlace, hint);
+		}
+	}
+
 	Task *stealTask()
 	{
 		return nullptr;
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "DeviceUnsyncScheduler.hpp"
@@ -12,11 +12,9 @@ Task *DeviceUnsyncScheduler::getReadyTask(ComputePlace *computePlace)
 
 	// 1. Check if there is an immediate successor.
 	if (_enableImmediateSuccessor && computePlace != nullptr) {
-		size_t immediateSuccessorId = computePlace->getIndex();
-		if (_immediateSuccessorTasks[immediateSuccessorId] != nullptr) {
-			task = _immediateSuccessorTasks[immediateSuccessorId];
+		task = getImmediateSuccessor(computePlace->getIndex());
+		if (task != nullptr) {
 			assert(!task->isTaskfor());
-			_immediateSuccessorTasks[immediateSuccessorId] = nullptr;
 			return task;
 		}
 	}
@@ -26,14 +24,8 @@ Task *DeviceUnsyncScheduler::getReadyTask(ComputePlace *computePlace)
 
 	// 3. Try to get work from other immediateSuccessorTasks.
 	if (task == nullptr && _enableImmediateSuccessor) {
-		for (size_t i = 0; i < _immediateSuccessorTasks.size(); i++) {
-			if (_immediateSuccessorTasks[i] != nullptr) {
-				task = _immediateSuccessorTasks[i];
-				assert(!task->isTaskfor());
-				_immediateSuccessorTasks[i] = nullptr;
-				break;
-			}
-		}
+		const size_t computePlaceId = (computePlace != nullptr) ? computePlace->getIndex() : 0;
+		task = stealImmediateSuccessor(computePlaceId);
 	}
 
 	assert(task == nullptr || !task->isTaskfor());
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef ATOMIC_BITSET_HPP
@@ -102,6 +102,72 @@ public:
 		elem.fetch_and(~(ONE << getBitIndex(pos)), std::memory_order_release);
 	}
 
+	//! \brief Reset a single bit in the AtomicBitset (to 0) and check whether it was set
+	//!
+	//! \remark This function is atomic and has acquire semantics
+	//! \remark This function is wait-free and has O(1) complexity
+	//!
+	//! \param[in] pos position of the bit to reset
+	//!
+	//! \return true if the bit was set and this call reset it, false otherwise
+	inline bool testAndReset(size_t pos)
+	{
+		backing_t &elem = getStorage(pos);
+		const backingstorage_t mask = (ONE << getBitIndex(pos));
+		return (elem.fetch_and(~mask, std::memory_order_acquire) & mask);
+	}
+
+	//! \brief Reset the set bits that satisfy a condition, up to a maximum amount
+	//!
+	//! \remark The matching bits of each backing storage element are reset with a
+	//!         single atomic operation, and only the bits that were still set are
+	//!         passed to the processor, so concurrent calls never obtain the same bit
+	//! \remark This function is lock-free and has O(size) complexity
+	//!
+	//! \param[in] maxCount the maximum amount of bits to reset
+	//! \param[in] condition a lambda that receives the position of a set bit and
+	//!            returns whether it should be reset
+	//! \param[in] processor a lambda that receives the position of each bit reset by this call
+	//!
+	//! \return the amount of bits reset by this call
+	template <typename ConditionType, typename ProcessorType>
+	inline size_t resetMatching(size_t maxCount, ConditionType condition, ProcessorType processor)
+	{
+		size_t count = 0;
+
+		for (size_t base = 0; base < _size && count < maxCount; base += bitsizeof(backingstorage_t)) {
+			backing_t &elem = getStorage(base);
+			backingstorage_t value = elem.load(std::memory_order_relaxed);
+
+			while (value != 0 && count < maxCount) {
+				//! Select the matching bits without exceeding the maximum
+				backingstorage_t mask = 0;
+				size_t selected = 0;
+				for (backingstorage_t pending = value; pending != 0 && count + selected < maxCount; pending &= pending - 1) {
+					const size_t bit = __builtin_ctzll(pending);
+					if (condition(base + bit)) {
+						mask |= (ONE << bit);
+						++selected;
+					}
+				}
+
+				if (mask == 0)
+					break;
+
+				const backingstorage_t previous = elem.fetch_and(~mask, std::memory_order_acquire);
+				for (backingstorage_t obtained = previous & mask; obtained != 0; obtained &= obtained - 1) {
+					processor(base + __builtin_ctzll(obtained));
+					++count;
+				}
+
+				//! Look again at the bits set by other threads in the meantime
+				value = previous & ~mask;
+			}
+		}
+
+		return count;
+	}
+
 	//! \brief Set the first found zero-bit in the AtomicBitset
 	//!
 	//! \remark This function only provides one guarantee: if a position != -1 is
@@ -126,12 +126,17 @@ ConfigCentral::ConfigCentral() :
 	registerOption<string_t>("loader.report_prefix", "");
 
 	// Memory allocator
+	registerOption<string_t>("memory.huge_pages", "none");
+	registerOption<memory_t>("memory.huge_page_size", 2 * 1024 * 1024);
 	registerOption<memory_t>("memory.pool.global_alloc_size", 8 * 1024 * 1024);
 	registerOption<memory_t>("memory.pool.chunk_size", 128 * 1024);
+	registerOption<memory_t>("memory.pool.cpu_high_water", 512 * 1024);
 
 	// Miscellaneous
 	registerOption<integer_t>("misc.polling_frequency", 1000);
+	registerOption<bool_t>("misc.mutex_statistics", false);
 	registerOption<bool_t>("misc.polling", true);
+	registerOption<bool_t>("misc.polling_statistics", false);
 	registerOption<memory_t>("misc.stack_size", 8 * 1024 * 1024);
 
 	// Monitoring
@@ -151,18 +156,22 @@ ConfigCentral::ConfigCentral() :
 
 	// Scheduler
 	registerOption<bool_t>("scheduler.immediate_successor", true);
+	registerOption<integer_t>("scheduler.immediate_successor_depth", 1);
 	registerOption<string_t>("scheduler.policy", "fifo");
 	registerOption<bool_t>("scheduler.priority", true);
 
 	// Taskfor
 	registerOption<integer_t>("taskfor.groups", 1);
 	registerOption<bool_t>("taskfor.report", false);
+	registerOption<string_t>("taskfor.schedule", "static");
 
 	// Throttle
 	registerOption<bool_t>("throttle.enabled", false);
+	registerOption<integer_t>("throttle.max_accesses", 10000000);
 	registerOption<memory_t>("throttle.max_memory", 0);
 	registerOption<integer_t>("throttle.polling_period_us", 1000);
 	registerOption<integer_t>("throttle.pressure", 70);
+	registerOption<integer_t>("throttle.ready_tasks_per_cpu", 100);
 	registerOption<integer_t>("throttle.tasks", 5000000);
 
 	// Turbo
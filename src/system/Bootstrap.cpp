@@ -31,9 +31,11 @@
 #include "support/config/ConfigCentral.hpp"
 #include "support/config/ConfigChecker.hpp"
 #include "system/APICheck.hpp"
+#include "system/PollingAPI.hpp"
 #include "system/RuntimeInfoEssentials.hpp"
 #include "system/Throttle.hpp"
 #include "system/ompss/SpawnFunction.hpp"
+#include "system/ompss/UserMutex.hpp"
 #include "tasks/StreamManager.hpp"
 
 #include <ClusterManager.hpp>
@@ -106,6 +108,7 @@ void nanos6_preinit(int argc, char **argv)
 	NUMAManager::initialize();
 	Scheduler::initialize();
 	Throttle::initialize();
+	UserMutex::initialize();
 	ExternalThreadGroup::initialize();
 
 	// Initialize device services after initializing scheduler
@@ -157,8 +160,12 @@ void nanos6_shutdown(void)
 	// Shutdown device services before CPU and thread managers
 	HardwareInfo::shutdownDeviceServices();
 
-	// This must be after HardwareInfo::shutdownDeviceServices(), otherwise
-	// the spawned device services will still be pending.
+	// Shutdown throttle service before CPUs are stopped
+	Throttle::shutdown();
+
+	// This must be after HardwareInfo::shutdownDeviceServices() and
+	// Throttle::shutdown(), otherwise the spawned services will still
+	// be pending.
 	while (SpawnFunction::_pendingSpawnedFunctions > 0) {
 		// Wait for spawned functions to fully end
 	}
@@ -167,9 +174,6 @@ void nanos6_shutdown(void)
 	StreamManager::shutdown();
 	LeaderThread::shutdown();
 
-	// Shutdown throttle service before CPUs are stopped
-	Throttle::shutdown();
-
 	// Signal the shutdown to all CPUs and finalize threads
 	ClusterManager::shutdownPhase1();
 	CPUManager::shutdownPhase1();
@@ -195,6 +199,12 @@ void nanos6_shutdown(void)
 
 	ClusterManager::shutdownPhase2();
 
+	// No thread polls services at this point
+	PollingAPI::shutdown();
+
+	// No task holds the user mutexes at this point
+	UserMutex::shutdown();
+
 	HardwareInfo::shutdown();
 	MemoryAllocator::shutdown();
 	RuntimeInfoEssentials::shutdown();
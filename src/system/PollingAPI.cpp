@@ -1,159 +1,286 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <iomanip>
+#include <iostream>
 #include <map>
 #include <mutex>
 #include <sstream>
 #include <string>
-#include <atomic>
 
 #include <nanos6/polling.h>
 
 #include "PollingAPI.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
-#include "lowlevel/PaddedSpinLock.hpp"
+#include "lowlevel/SpinLock.hpp"
+#include "support/Chrono.hpp"
 #include "support/config/ConfigVariable.hpp"
 #include "system/RuntimeInfo.hpp"
 
 
 namespace PollingAPI {
-	typedef PaddedSpinLock<> lock_t;
+	typedef SpinLock lock_t;
+
+	enum service_state_t {
+		//! The node does not hold a service and can be reused
+		FREE_SERVICE = 0,
+		//! The service is registered and nobody is calling it
+		IDLE_SERVICE,
+		//! A thread is calling the service
+		RUNNING_SERVICE
+	};
+
+	//! \brief A registered service
+	//!
+	//! The nodes are linked in one list per priority and they are not removed
+	//! from the lists until the runtime shuts down. The unregistered nodes are
+	//! reused by the following registrations of the same priority
+	struct Service {
+		std::atomic<int> _state;
+
+		//! A pointer to an area that is set when the service has been marked for
+		//! removal and that will be set to true once the service has been unregistered
+		std::atomic<std::atomic<bool> *> _discard;
 
-	//! \brief the parameters of the nanos6_register_polling_service function
-	struct ServiceKey {
+		//! Time after which the service must be called again, in nanoseconds
+		std::atomic<uint64_t> _nextCall;
+
+		//! The parameters of the registration, which only change while the
+		//! node is free
 		std::string _name;
 		nanos6_polling_service_t _function;
 		void *_functionData;
-
-		ServiceKey(char const *name, nanos6_polling_service_t function, void *functionData)
-			: _name(name), _function(function), _functionData(functionData)
-		{
-		}
-
-		ServiceKey(ServiceKey &&other)
-			: _name(std::move(other._name)), _function(other._function), _functionData(other._functionData)
+		uint64_t _period;
+
+		//! Statistics, only updated by the thread that is calling the service
+		size_t _calls;
+		uint64_t _totalTime;
+		uint64_t _maxTime;
+
+		//! The next node of the list, which never changes once linked
+		Service *_next;
+
+		Service() :
+			_state(FREE_SERVICE),
+			_discard(nullptr),
+			_nextCall(0),
+			_function(nullptr),
+			_functionData(nullptr),
+			_period(0),
+			_calls(0),
+			_totalTime(0),
+			_maxTime(0),
+			_next(nullptr)
 		{
 		}
 	};
 
 
-	//! \brief the status of a service
-	struct ServiceData {
-		//! \brief Indicates whether the service is being processed at that moment
-		bool _processing;
-
-		//! \brief A pointer to an area that is set when the service has been marked for removal and that will be set to true once the service has been unregistered
-		std::atomic<bool> *_discard;
+	//! \brief Held by registrations and unregistrations, but never while polling
+	lock_t _registrationLock;
 
-		ServiceData()
-			: _processing(false), _discard(nullptr)
-		{
-		}
-	};
+	//! \brief Services in the system, one list per priority
+	std::atomic<Service *> _services[NUM_PRIORITIES];
 
+	//! \brief Statistics of the services that have already been unregistered
+	std::ostringstream _retiredStatistics;
 
-	// Container type for the services
-	typedef std::map<ServiceKey, ServiceData> services_t;
+	//! \brief Environment variable to enable/disable polling services
+	ConfigVariable<bool> _enabled("misc.polling");
 
+	//! \brief Whether the statistics of the services are reported at shutdown
+	ConfigVariable<bool> _reportStatistics("misc.polling_statistics");
 
-	//! \brief This is held during traversal and modification operations but not while processing a service
-	lock_t _lock;
 
-	//! \brief Services in the system
-	services_t _services;
+	static inline const char *getPriorityName(size_t priority)
+	{
+		static const char *names[NUM_PRIORITIES] = { "high", "normal", "low" };
+		assert(priority < NUM_PRIORITIES);
+		return names[priority];
+	}
 
-	//! \brief Environment variable to enable/disable polling services
-	ConfigVariable<bool> _enabled("misc.polling");
+	static void printStatistics(std::ostream &stream, Service *service, size_t priority)
+	{
+		const double calls = std::max(service->_calls, (size_t) 1);
+
+		stream << std::left << std::setw(40) << service->_name << std::right
+			<< std::setw(8) << getPriorityName(priority)
+			<< std::setw(12) << service->_period / 1000
+			<< std::setw(12) << service->_calls
+			<< std::setw(12) << std::fixed << std::setprecision(2) << (service->_totalTime / calls) / 1000.0
+			<< std::setw(12) << service->_maxTime / 1000.0 << std::endl;
+	}
 
+	//! \brief Find the node of a registered service. The registration lock must be held
+	static Service *findService(nanos6_polling_service_t function, void *functionData)
+	{
+		for (size_t priority = 0; priority < NUM_PRIORITIES; priority++) {
+			Service *service = _services[priority].load(std::memory_order_relaxed);
+			while (service != nullptr) {
+				if (service->_state.load(std::memory_order_acquire) != FREE_SERVICE
+					&& service->_function == function
+					&& service->_functionData == functionData
+				) {
+					return service;
+				}
+				service = service->_next;
+			}
+		}
+		return nullptr;
+	}
 
-	inline bool operator<(ServiceKey const &a, ServiceKey const &b)
+	//! \brief Unregister a service that the calling thread has claimed
+	static void retireService(Service *service, size_t priority)
 	{
-		if (a._function < b._function) {
-			return true;
-		} else if (a._function > b._function) {
-			return false;
+		assert(service->_state.load(std::memory_order_relaxed) == RUNNING_SERVICE);
+
+		std::lock_guard<lock_t> guard(_registrationLock);
+
+		if (_reportStatistics) {
+			printStatistics(_retiredStatistics, service, priority);
 		}
 
-		if (a._functionData < b._functionData) {
-			return true;
-		} else if (a._functionData > b._functionData) {
-			return false;
+		std::atomic<bool> *discard = service->_discard.exchange(nullptr, std::memory_order_relaxed);
+		service->_state.store(FREE_SERVICE, std::memory_order_release);
+
+		// Signal the unregistration
+		if (discard != nullptr) {
+			discard->store(true);
 		}
+	}
 
-#if 0
-		if (a._name < b._name) {
-			return true;
-		} else if (a._name > b._name) {
-			return false;
+	//! \brief Call a service if it is due and nobody else is calling it
+	static void handleService(Service *service, size_t priority, uint64_t now)
+	{
+		if (service->_state.load(std::memory_order_relaxed) != IDLE_SERVICE)
+			return;
+
+		// Services marked for removal can be removed by anyone
+		const bool discarded = (service->_discard.load(std::memory_order_relaxed) != nullptr);
+		if (!discarded && now < service->_nextCall.load(std::memory_order_relaxed))
+			return;
+
+		int expected = IDLE_SERVICE;
+		if (!service->_state.compare_exchange_strong(expected, RUNNING_SERVICE, std::memory_order_acquire))
+			return;
+
+		// The service may have been marked for removal after the previous checks
+		if (service->_discard.load(std::memory_order_relaxed) != nullptr) {
+			retireService(service, priority);
+			return;
 		}
-#endif
 
-		return false; // Equal
+		const uint64_t start = Chrono::now<uint64_t, std::nano>();
+		bool unregister = service->_function(service->_functionData);
+		const uint64_t elapsed = Chrono::now<uint64_t, std::nano>() - start;
+
+		service->_calls++;
+		service->_totalTime += elapsed;
+		service->_maxTime = std::max(service->_maxTime, elapsed);
+
+		// If the function returns true or the service had been marked for unregistration, remove the service
+		if (unregister || service->_discard.load(std::memory_order_relaxed) != nullptr) {
+			retireService(service, priority);
+		} else {
+			service->_nextCall.store(start + service->_period, std::memory_order_relaxed);
+			service->_state.store(IDLE_SERVICE, std::memory_order_release);
+		}
 	}
 }
 
 
 using namespace PollingAPI;
 
-extern "C" void nanos6_register_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data)
-{
+void PollingAPI::registerService(
+	char const *name,
+	nanos6_polling_service_t function,
+	void *functionData,
+	const ServiceAttributes &attributes
+) {
 	FatalErrorHandler::failIf(!_enabled, "Polling services API is disabled");
+	assert(attributes._priority < NUM_PRIORITIES);
 
-	std::lock_guard<PollingAPI::lock_t> guard(PollingAPI::_lock);
+	std::lock_guard<lock_t> guard(_registrationLock);
 
 	static std::map<nanos6_polling_service_t, std::string> uniqueRegisteredServices;
 
-	auto result = PollingAPI::_services.emplace(
-		ServiceKey(service_name, service_function, service_data),
-		ServiceData()
-	);
+	Service *service = findService(function, functionData);
+	if (service != nullptr) {
+		// The service was already registered, so it must have been marked as discarded
+		assert(service->_discard.load() != nullptr);
 
-	if (!result.second) {
-		// The node was already added
-		ServiceData &serviceData = result.first->second;
+		// Remove the mark
+		service->_discard.store(nullptr);
+		return;
+	}
 
-		// So it must have been marked as discarded
-		assert(serviceData._discard != nullptr);
+	// Reuse a free node of the same priority
+	std::atomic<Service *> &list = _services[attributes._priority];
+	service = list.load(std::memory_order_relaxed);
+	while (service != nullptr && service->_state.load(std::memory_order_relaxed) != FREE_SERVICE) {
+		service = service->_next;
+	}
 
-		// Remove the mark
-		serviceData._discard = nullptr;
-	} else {
-		auto it = uniqueRegisteredServices.find(service_function);
-		if (it == uniqueRegisteredServices.end()) {
-			uniqueRegisteredServices[service_function] = service_name;
-			std::ostringstream oss, oss2;
-			oss << "registered_service_" << uniqueRegisteredServices.size();
-			oss2 << "Registered Service " << uniqueRegisteredServices.size();
-
-			RuntimeInfo::addEntry(oss.str(), oss2.str(), service_name);
-		}
+	const bool newNode = (service == nullptr);
+	if (newNode) {
+		service = new Service();
+		service->_next = list.load(std::memory_order_relaxed);
+	}
+
+	service->_name = name;
+	service->_function = function;
+	service->_functionData = functionData;
+	service->_period = attributes._periodUs * 1000;
+	service->_calls = 0;
+	service->_totalTime = 0;
+	service->_maxTime = 0;
+	service->_nextCall.store(0, std::memory_order_relaxed);
+	service->_state.store(IDLE_SERVICE, std::memory_order_release);
+
+	// Publish the node to the threads that traverse the list without locking
+	if (newNode) {
+		list.store(service, std::memory_order_release);
 	}
+
+	auto it = uniqueRegisteredServices.find(function);
+	if (it == uniqueRegisteredServices.end()) {
+		uniqueRegisteredServices[function] = name;
+		std::ostringstream oss, oss2;
+		oss << "registered_service_" << uniqueRegisteredServices.size();
+		oss2 << "Registered Service " << uniqueRegisteredServices.size();
+
+		RuntimeInfo::addEntry(oss.str(), oss2.str(), name);
+	}
+}
+
+
+extern "C" void nanos6_register_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data)
+{
+	PollingAPI::registerService(service_name, service_function, service_data, ServiceAttributes());
 }
 
 
-extern "C" void nanos6_unregister_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data)
+extern "C" void nanos6_unregister_polling_service(char const *, nanos6_polling_service_t service_function, void *service_data)
 {
 	FatalErrorHandler::failIf(!_enabled, "Polling service API is disabled");
 
 	std::atomic<bool> unregistered(false);
 
-	ServiceKey key(service_name, service_function, service_data);
-
 	{
-		std::lock_guard<PollingAPI::lock_t> guard(PollingAPI::_lock);
-		auto it = PollingAPI::_services.find(key);
-
-		assert((it != PollingAPI::_services.end()) && "Attempt to unregister a non-existing polling service");
-		ServiceData &serviceData = it->second;
+		std::lock_guard<lock_t> guard(_registrationLock);
+		Service *service = findService(service_function, service_data);
 
-		assert((serviceData._discard == nullptr) && "Attempt to unregister an already unregistered polling service");
+		assert((service != nullptr) && "Attempt to unregister a non-existing polling service");
+		assert((service->_discard.load() == nullptr) && "Attempt to unregister an already unregistered polling service");
 
 		// Set up unregistering protocol
-		serviceData._discard = &unregistered;
+		service->_discard.store(&unregistered);
 	}
 
 	// Wait until fully unregistered
@@ -169,58 +296,46 @@ void PollingAPI::handleServices()
 	if (!_enabled)
 		return;
 
-	bool locked = PollingAPI::_lock.tryLock();
-	if (!locked)
-		return;
+	const uint64_t now = Chrono::now<uint64_t, std::nano>();
 
-	auto it = _services.begin();
-	while (it != _services.end()) {
-		ServiceKey const &serviceKey = it->first;
-		ServiceData &serviceData = it->second;
-
-		if (serviceData._processing) {
-			// Somebody else processing it?
-			it++;
-			continue;
+	for (size_t priority = 0; priority < NUM_PRIORITIES; priority++) {
+		Service *service = _services[priority].load(std::memory_order_acquire);
+		while (service != nullptr) {
+			handleService(service, priority, now);
+			service = service->_next;
 		}
+	}
+}
 
-		if (serviceData._discard != nullptr) {
-			// Signal the unregistration
-			serviceData._discard->store(true);
-
-			it = _services.erase(it);
-			continue;
-		}
-
-		// Set the processing flag
-		assert(!serviceData._processing);
-		serviceData._processing = true;
-
-		// Execute the callback without locking
-		PollingAPI::_lock.unlock();
-		bool unregister = serviceKey._function(serviceKey._functionData);
-		PollingAPI::_lock.lock();
-
-		// Unset the processing flag
-		assert(serviceData._processing);
-		serviceData._processing = false;
-
-		// By construction, even in the presence of concurrent calls to this method, the iterator remains valid
 
-		// If the function returns true or the service had been marked for unregistration, remove the service
-		if (unregister || (serviceData._discard != nullptr)) {
+void PollingAPI::shutdown()
+{
+	std::ostringstream report;
+	if (_reportStatistics) {
+		report << std::left << std::setw(40) << "Polling service" << std::right
+			<< std::setw(8) << "Prio"
+			<< std::setw(12) << "Period(us)"
+			<< std::setw(12) << "Calls"
+			<< std::setw(12) << "Avg(us)"
+			<< std::setw(12) << "Max(us)" << std::endl;
+		report << _retiredStatistics.str();
+	}
 
-			if (serviceData._discard != nullptr) {
-				// Signal the unregistration
-				serviceData._discard->store(true);
+	// No thread polls at this point
+	for (size_t priority = 0; priority < NUM_PRIORITIES; priority++) {
+		Service *service = _services[priority].exchange(nullptr);
+		while (service != nullptr) {
+			if (_reportStatistics && service->_state.load() != FREE_SERVICE) {
+				printStatistics(report, service, priority);
 			}
 
-			it = _services.erase(it);
-		} else {
-			it++;
+			Service *next = service->_next;
+			delete service;
+			service = next;
 		}
 	}
 
-	PollingAPI::_lock.unlock();
+	if (_reportStatistics) {
+		std::cerr << report.str();
+	}
 }
-
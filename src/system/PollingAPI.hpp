@@ -1,16 +1,60 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef POLLING_API_HPP
 #define POLLING_API_HPP
 
+#include <cstdint>
+
+#include <nanos6/polling.h>
+
 
 namespace PollingAPI {
-	//! \brief Process the current list of services once
+	//! \brief The priority of a service, which determines the order in which
+	//! the services are called on each pass. It does not change how often a
+	//! service is called, which only depends on its period and on how often
+	//! the threads poll
+	enum service_priority_t {
+		HIGH_PRIORITY = 0,
+		NORMAL_PRIORITY,
+		LOW_PRIORITY,
+		NUM_PRIORITIES
+	};
+
+	//! \brief The scheduling attributes of a service
+	struct ServiceAttributes {
+		//! Minimum time between two calls to the service, in microseconds.
+		//! Zero means that the service is called on every pass
+		uint64_t _periodUs;
+
+		service_priority_t _priority;
+
+		ServiceAttributes(uint64_t periodUs = 0, service_priority_t priority = NORMAL_PRIORITY) :
+			_periodUs(periodUs),
+			_priority(priority)
+		{
+		}
+	};
+
+	//! \brief Register a service with scheduling attributes
+	//!
+	//! Services registered through nanos6_register_polling_service have
+	//! the default attributes. They are unregistered in the same way
+	void registerService(
+		char const *name,
+		nanos6_polling_service_t function,
+		void *functionData,
+		const ServiceAttributes &attributes
+	);
+
+	//! \brief Process once the services that are due
 	void handleServices();
+
+	//! \brief Report the statistics of the services if requested
+	void shutdown();
 }
 
 
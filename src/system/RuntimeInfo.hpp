@@ -1,13 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef RUNTIME_INFO_HPP
 #define RUNTIME_INFO_HPP
 
 
+#include <cassert>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -114,6 +115,28 @@ public:
 	}
 
 
+	//! \brief Update the value of an integer entry that has already been added
+	//!
+	//! \returns Whether the entry was found
+	static bool updateEntry(std::string const &name, long value)
+	{
+		bool found = false;
+
+		_lock.lock();
+		for (nanos6_runtime_info_entry_t &entry : _contents) {
+			if (name == entry.name) {
+				assert(entry.type == nanos6_integer_runtime_info_entry);
+				entry.integer = value;
+				found = true;
+				break;
+			}
+		}
+		_lock.unlock();
+
+		return found;
+	}
+
+
 	template <typename ITERATOR_T>
 	static void addListEntry(std::string const &name, std::string const &description, ITERATOR_T begin, ITERATOR_T end, std::string const &units = "")
 	{
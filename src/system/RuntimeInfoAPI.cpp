@@ -1,12 +1,16 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include <cassert>
 
+#include <DependencySystem.hpp>
+#include <MemoryAllocator.hpp>
+
 #include "RuntimeInfo.hpp"
+#include "system/ompss/UserMutex.hpp"
 
 #include "api/nanos6/runtime-info.h"
 
@@ -17,10 +21,29 @@ union index_or_pointer_t {
 };
 
 
+//! \brief Refresh the entries whose value changes while the runtime runs
+static void updateDynamicEntries()
+{
+	if (MemoryAllocator::hasUsageStatistics()) {
+		size_t usedBytes, cachedBytes, obtainedBytes;
+		MemoryAllocator::getMemoryStatistics(usedBytes, cachedBytes, obtainedBytes);
+
+		RuntimeInfo::updateEntry("memory_in_use", usedBytes);
+		RuntimeInfo::updateEntry("memory_cached", cachedBytes);
+		RuntimeInfo::updateEntry("memory_obtained", obtainedBytes);
+	}
+
+	DependencySystem::updateRuntimeInfo();
+	UserMutex::updateRuntimeInfo();
+}
+
+
 void *nanos6_runtime_info_begin(void)
 {
 	index_or_pointer_t result;
 	
+	updateDynamicEntries();
+	
 	result._index = 0;
 	
 	return result._pointer;
@@ -4,12 +4,20 @@
 	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
+#include <algorithm>
+
 #include <nanos6.h>
 
+#include <ClusterManager.hpp>
+#include <DataAccess.hpp>
 #include <MemoryAllocator.hpp>
+#include <ObjectAllocator.hpp>
 
 #include "DataAccessRegistration.hpp"
 #include "Throttle.hpp"
+#include "cluster/ClusterMetrics.hpp"
+#include "executors/threads/CPUManager.hpp"
+#include "hardware/HardwareInfo.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "system/ompss/TaskBlocking.hpp"
 #include "system/ompss/TaskWait.hpp"
@@ -21,16 +29,17 @@ ConfigVariable<int> Throttle::_throttleTasks("throttle.tasks");
 ConfigVariable<int> Throttle::_throttlePressure("throttle.pressure");
 ConfigVariable<StringifiedMemorySize> Throttle::_throttleMem("throttle.max_memory");
 ConfigVariable<size_t> Throttle::_throttlePollingPeriod("throttle.polling_period_us");
+ConfigVariable<size_t> Throttle::_throttleAccesses("throttle.max_accesses");
+ConfigVariable<size_t> Throttle::_throttleReadyTasks("throttle.ready_tasks_per_cpu");
+size_t Throttle::_maxReadyTasks;
 
 std::atomic<bool> Throttle::_stopService;
 std::atomic<bool> Throttle::_finishedService;
 
 void Throttle::initialize()
 {
-	// If we don't have usage statistics, we cannot enable the Throttle
-	if (!MemoryAllocator::hasUsageStatistics())
-		_enabled.setValue(false);
-
+	// Without usage statistics of the allocator, the throttle still
+	// considers the rest of the signals
 	if (!_enabled)
 		return;
 
@@ -38,6 +47,8 @@ void Throttle::initialize()
 	if (_throttleMem.getValue() == 0)
 		_throttleMem.setValue(HardwareInfo::getPhysicalMemorySize() / 2);
 
+	_maxReadyTasks = _throttleReadyTasks.getValue() * CPUManager::getTotalCPUs();
+
 	_pressure = 0;
 	_stopService = false;
 	_finishedService = false;
@@ -71,14 +82,58 @@ void Throttle::evaluate(void *)
 	assert(_throttleMem.getValue() != 0);
 
 	while (!_stopService.load(std::memory_order_relaxed)) {
-		size_t memoryUsage = MemoryAllocator::getMemoryUsage();
-		_pressure = std::min((memoryUsage * 100) / _throttleMem.getValue(), (size_t)100);
+		int pressure = computeMemoryPressure();
+		pressure = std::max(pressure, computeDependencyPressure());
+		pressure = std::max(pressure, computeSchedulerPressure());
+		_pressure = pressure;
 
 		// Sleep for a configured amount of microseconds
 		BlockingAPI::waitForUs(sleepTime);
 	}
 }
 
+int Throttle::computeMemoryPressure()
+{
+	if (!MemoryAllocator::hasUsageStatistics())
+		return 0;
+
+	// Most of the memory comes from the global pool of the first NUMA node,
+	// so the usage is only limited globally
+	return computePressure(MemoryAllocator::getMemoryUsage(), _throttleMem.getValue());
+}
+
+int Throttle::computeDependencyPressure()
+{
+	// Accesses that are allocated with their task, such as the ones of the
+	// discrete dependencies, are bounded by the number of child tasks
+	if (!ObjectAllocator<DataAccess>::hasObjectStatistics())
+		return 0;
+
+	// The counters of the CPUs are read while they change, so the estimation
+	// may be transiently negative
+	long liveAccesses = (long) ObjectAllocator<DataAccess>::getNumObjects();
+
+	return computePressure(std::max(liveAccesses, 0L), _throttleAccesses.getValue());
+}
+
+int Throttle::computeSchedulerPressure()
+{
+	int pressure = computePressure(Scheduler::getNumReadyTasks(), _maxReadyTasks);
+
+	// Offloaded tasks that have not finished are ready work that waits in
+	// other nodes, which are assumed to have as many CPUs as this one
+	if (ClusterManager::inClusterMode()) {
+		const size_t offloaded = ClusterMetrics::getSentNumNewTask();
+		const size_t finished = ClusterMetrics::getReceivedNumTaskFinished();
+		const size_t pending = (offloaded > finished) ? offloaded - finished : 0;
+		const size_t remoteNodes = std::max(ClusterManager::clusterSize() - 1, 1);
+
+		pressure = std::max(pressure, computePressure(pending, _maxReadyTasks * remoteNodes));
+	}
+
+	return pressure;
+}
+
 void Throttle::complete(void *)
 {
 	assert(_stopService);
@@ -87,10 +142,10 @@ void Throttle::complete(void *)
 }
 
 // Each task has a maximum number of child tasks, which decreases at a 10x rate per nesting level
-// determined by throttle.tasks. Also, when the memory pressure reaches throttle.max_memory
-// the number of tasks dicreases linearly between that point and 100% memory pressure. At a 100%
-// memory pressure, there is only 1 allowed tasks, which will trigger a taskwait to reduce
-// memory usage.
+// determined by throttle.tasks. Also, when the pressure reaches throttle.pressure the number
+// of tasks dicreases linearly between that point and 100% pressure. At a 100% pressure, there
+// is only 1 allowed tasks, so the creator executes ready tasks or runs a taskwait to reduce
+// the pressure.
 int Throttle::getAllowedTasks(int nestingLevel)
 {
 	int standardAllowedTasks = _throttleTasks;
@@ -124,11 +179,6 @@ bool Throttle::engage(Task *creator, WorkerThread *workerThread)
 	assert(workerThread != nullptr);
 	assert(workerThread->getTask() == creator);
 
-	// We cannot safely throttle taskloops because we cannot prevent
-	// a taskloop from creating child tasks.
-	if (creator->isTaskloop())
-		return false;
-
 	// How many child tasks is this creator allowed?
 	int nestingLevel = creator->getNestingLevel();
 	int allowedChildTasks = getAllowedTasks(nestingLevel);
@@ -140,22 +190,35 @@ bool Throttle::engage(Task *creator, WorkerThread *workerThread)
 	CPU *currentCPU = workerThread->getComputePlace();
 	assert(currentCPU != nullptr);
 
-	// Let's try and give the worker thread a different task to execute while we wait
+	// Let's try and give the worker thread a different task to execute while we wait.
+	// At full pressure the creator waits for its children instead, since the ready
+	// task could be another creator whose children depend on the ones this creator
+	// has not created yet
 	Task *replacement = nullptr;
-
-	if (allowedChildTasks != 1)
+	if (allowedChildTasks != 1 && workerThread->isTaskReplaceable())
 		replacement = Scheduler::getReadyTask(currentCPU);
 
-	if (replacement != nullptr && workerThread->isTaskReplaceable()) {
+	// Tasks that are already assigned to another thread, such as the ones
+	// resuming from a blocking operation, cannot run on this one
+	if (replacement != nullptr && replacement->getThread() != nullptr) {
+		Scheduler::addReadyTask(replacement, currentCPU, UNBLOCKED_TASK_HINT);
+		replacement = nullptr;
+	}
+
+	if (replacement != nullptr) {
 		workerThread->replaceTask(replacement);
 		workerThread->handleTask(currentCPU);
 
 		// Restore
 		workerThread->restoreTask(creator);
 		return true;
-	} else {
+	} else if (!creator->isTaskloop()) {
 		// There is nothing else to do. Let's run a taskwait then
 		TaskWait::taskWait("Throttle");
 		return false;
+	} else {
+		// We cannot make taskloops wait because they create their child
+		// tasks inside the runtime, so they just continue
+		return false;
 	}
 }
@@ -14,6 +14,25 @@
 class Task;
 class WorkerThread;
 
+//! \brief Admission control for the creation of tasks
+//!
+//! The throttle periodically evaluates a pressure between 0 and 100%, which
+//! is the highest pressure among these signals:
+//! - The memory used by the runtime
+//! - The live data accesses of the dependency system, including fragments.
+//!   Only the pool allocator counts them, so this pressure is always zero
+//!   with the malloc and jemalloc allocators
+//! - The number of ready tasks per CPU in the scheduler
+//! - The tasks offloaded to other nodes that have not finished yet
+//!
+//! When the pressure exceeds throttle.pressure, the number of child tasks
+//! allowed to each creator decays. Creators that exceed it execute ready
+//! tasks instead of creating more, and wait for their children when there
+//! is no ready work. At full pressure each creator is allowed a single child
+//! and always waits for its children without executing other ready tasks,
+//! since they could be creators whose children depend on the ones it has
+//! not created yet. Taskloops never wait, since they create their children
+//! inside the runtime
 class Throttle {
 private:
 	static int _pressure;
@@ -22,12 +41,38 @@ private:
 	static ConfigVariable<int> _throttlePressure;
 	static ConfigVariable<StringifiedMemorySize> _throttleMem;
 	static ConfigVariable<size_t> _throttlePollingPeriod;
+	static ConfigVariable<size_t> _throttleAccesses;
+	static ConfigVariable<size_t> _throttleReadyTasks;
+
+	//! Number of ready tasks, and of tasks offloaded to each remote node,
+	//! at which their pressure reaches 100%
+	static size_t _maxReadyTasks;
 
 	static std::atomic<bool> _stopService;
 	static std::atomic<bool> _finishedService;
 
 	static int getAllowedTasks(int nestingLevel);
 
+	//! \brief Get the pressure of a value with respect to its limit
+	//!
+	//! A limit of zero disables the signal, so its pressure is zero
+	static inline int computePressure(size_t value, size_t limit)
+	{
+		if (limit == 0)
+			return 0;
+
+		if (value >= limit)
+			return 100;
+
+		return (int) ((value * 100) / limit);
+	}
+
+	static int computeMemoryPressure();
+
+	static int computeDependencyPressure();
+
+	static int computeSchedulerPressure();
+
 public:
 	//! \brief Checks if the throttle is in active mode and should be engaged
 	//!
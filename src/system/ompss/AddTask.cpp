@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 // This is for posix_memalign
@@ -32,6 +32,7 @@
 #include "system/TrackingPoints.hpp"
 #include "tasks/StreamExecutor.hpp"
 #include "tasks/Task.hpp"
+#include "tasks/TaskAllocationCache.hpp"
 #include "tasks/TaskImplementation.hpp"
 #include "tasks/Taskfor.hpp"
 #include "tasks/Taskloop.hpp"
@@ -48,6 +49,11 @@
 
 #define DATA_ALIGNMENT_SIZE sizeof(void *)
 
+
+static char emptyLoop;
+void * const AddTask::EMPTY_LOOP_HANDLE = &emptyLoop;
+
+
 Task *AddTask::createTask(
 	nanos6_task_info_t *taskInfo,
 	nanos6_task_invocation_info_t *taskInvocationInfo,
@@ -102,10 +108,16 @@ Task *AddTask::createTask(
 	const size_t taskStatisticsSize = Monitoring::getAllocationSize();
 	const size_t taskConstraintsSize = sizeof(nanos6_task_constraints_t);
 
+	// Only the taskinfos registered through nanos6_register_task_info have
+	// tasktype data. The rest, such as the runtime's internal taskinfos and
+	// the ones received from other nodes, have it null and their blocks are
+	// not cached
+	TasktypeData *tasktypeData = (TasktypeData *) taskInfo->task_type_data;
+
 	bool hasPreallocatedArgsBlock = (flags & nanos6_preallocated_args_block);
 	if (hasPreallocatedArgsBlock) {
 		assert(argsBlock != nullptr);
-		task = (Task *) MemoryAllocator::alloc(taskSize
+		task = (Task *) TaskAllocationCache::allocateTaskBlock(tasktypeData, taskSize
 			+ taskAccessesSize
 			+ taskCountersSize
 			+ taskStatisticsSize
@@ -116,8 +128,9 @@ Task *AddTask::createTask(
 		const size_t correction = (DATA_ALIGNMENT_SIZE - missalignment) & (DATA_ALIGNMENT_SIZE - 1);
 		argsBlockSize += correction;
 
-		// Allocation and layout
-		argsBlock = MemoryAllocator::alloc(argsBlockSize + taskSize
+		// Allocation and layout. Blocks of disposed tasks of the same type are
+		// recycled; otherwise, they are allocated from the CPU pools
+		argsBlock = TaskAllocationCache::allocateTaskBlock(tasktypeData, argsBlockSize + taskSize
 			+ taskAccessesSize
 			+ taskCountersSize
 			+ taskStatisticsSize
@@ -211,6 +224,7 @@ void AddTask::submitTask(Task *task, Task *parent, bool fromUserCode)
 	bool distributedTaskloop = false;
 
 	if (task->isTaskloopSource()
+		  && ((Taskloop *) task)->getIterationCount() > 0
 		  && !task->isTaskloopOffloader()
 		  && !task->isRemoteTask()
 		  && (task->getConstraints()->node == nanos6_cluster_no_hint)) {
@@ -344,6 +358,11 @@ void nanos6_create_task(
 //! Public API function to submit tasks
 void nanos6_submit_task(void *task_handle)
 {
+	// Loops that were not created because they had no effect
+	if (task_handle == AddTask::EMPTY_LOOP_HANDLE) {
+		return;
+	}
+
 	Task *task = (Task *) task_handle;
 	assert(task != nullptr);
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef ADD_TASK_HPP
@@ -14,6 +14,10 @@
 
 namespace AddTask {
 
+	//! \brief Handle returned for loops that are not created because they have
+	//! no iterations nor dependencies. Submitting it has no effect
+	extern void * const EMPTY_LOOP_HANDLE;
+
 	//! \brief Allocate space for a task and its arguments
 	//!
 	//! This function creates a task and allocates space for its parameters. After calling it,
@@ -1,9 +1,10 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
+#include <algorithm>
 #include <cassert>
 
 #include <nanos6.h>
@@ -34,12 +35,34 @@ void nanos6_create_loop(
 		FatalErrorHandler::fail("No hardware associated for task device type", deviceType);
 	}
 
+	// Loops whose upper bound precedes the lower bound have no iterations
+	if (upper_bound < lower_bound) {
+		upper_bound = lower_bound;
+	}
+
+	// A loop without iterations nor dependencies has no effect, so do not create it. The compiler
+	// still fills an args block, which is scratch space of the current CPU, and submits the handle.
+	// Args blocks that need to be destroyed are not skipped, since they may hold objects
+	WorkerThread *workerThread = WorkerThread::getCurrentWorkerThread();
+	if (upper_bound == lower_bound && num_deps == 0
+		&& task_info->destroy_args_block == nullptr && workerThread != nullptr) {
+		if (!(flags & nanos6_preallocated_args_block)) {
+			CPU *cpu = workerThread->getComputePlace();
+			assert(cpu != nullptr);
+
+			*args_block_pointer = cpu->getEmptyLoopArgsBlock(args_block_size);
+		}
+		*task_pointer = AddTask::EMPTY_LOOP_HANDLE;
+		return;
+	}
+
 	// The compiler passes either the num deps of a single child or -1. However, the parent taskloop
-	// must register as many deps as num_deps * numTasks
+	// must register as many deps as num_deps * numTasks. Taskloops without iterations register the
+	// deps of a single child
 	bool isTaskloop = flags & nanos6_taskloop_task;
 	if (num_deps != (size_t) -1 && isTaskloop) {
 		size_t numTasks = Taskloop::computeNumTasks((upper_bound - lower_bound), grainsize);
-		num_deps *= numTasks;
+		num_deps *= std::max(numTasks, (size_t) 1);
 	}
 
 	Task *task = AddTask::createTask(
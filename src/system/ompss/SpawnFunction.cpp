@@ -219,14 +219,14 @@ void nanos6_stream_spawn_function(
 	char const *label,
 	size_t stream_id
 ) {
-	SpawnFunction::spawnFunction(
+	// The functions of a stream are executed in order by the executor of
+	// the stream, which is also the one that synchronizes the stream
+	StreamManager::createFunction(
 		function,
 		args,
 		completion_callback,
 		completion_args,
 		label,
-		true,
-		(size_t) Task::nanos6_task_runtime_flag_t::nanos6_stream_flag,
 		stream_id
 	);
 }
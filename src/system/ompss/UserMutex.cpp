@@ -1,10 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
 
 #include <nanos6.h>
 
@@ -20,12 +24,105 @@
 #include "executors/threads/WorkerThread.hpp"
 #include "lowlevel/SpinLock.hpp"
 #include "scheduling/Scheduler.hpp"
+#include "support/Chrono.hpp"
+#include "support/config/ConfigVariable.hpp"
+#include "system/RuntimeInfo.hpp"
 #include "system/TrackingPoints.hpp"
 #include "tasks/Task.hpp"
 #include "tasks/TaskImplementation.hpp"
 
 typedef std::atomic<UserMutex *> mutex_t;
 
+//! \brief Whether the statistics of the mutexes are reported at shutdown
+static ConfigVariable<bool> _reportStatistics("misc.mutex_statistics");
+
+//! \brief The mutexes that have been created, which are never freed
+static SpinLock _mutexesLock;
+static std::vector<UserMutex *> _mutexes;
+
+//! \brief The runtime information entries with the acquisitions of each kind
+static char const *_acquisitionEntries[] = {
+	"mutex_free_acquisitions",
+	"mutex_spin_acquisitions",
+	"mutex_handoff_acquisitions"
+};
+
+
+void UserMutex::initialize()
+{
+	if (!_reportStatistics)
+		return;
+
+	RuntimeInfo::addEntry(_acquisitionEntries[FREE_ACQUISITION], "User Mutex Free Acquisitions", 0L);
+	RuntimeInfo::addEntry(_acquisitionEntries[SPIN_ACQUISITION], "User Mutex Spin Acquisitions", 0L);
+	RuntimeInfo::addEntry(_acquisitionEntries[HANDOFF_ACQUISITION], "User Mutex Handoff Acquisitions", 0L);
+}
+
+void UserMutex::updateRuntimeInfo()
+{
+	if (!_reportStatistics)
+		return;
+
+	size_t acquisitions[3] = {};
+	{
+		std::lock_guard<SpinLock> guard(_mutexesLock);
+		for (UserMutex *userMutex : _mutexes) {
+			for (int type = FREE_ACQUISITION; type <= HANDOFF_ACQUISITION; ++type) {
+				acquisitions[type] += userMutex->_acquisitions[type];
+			}
+		}
+	}
+
+	for (int type = FREE_ACQUISITION; type <= HANDOFF_ACQUISITION; ++type) {
+		RuntimeInfo::updateEntry(_acquisitionEntries[type], acquisitions[type]);
+	}
+}
+
+void UserMutex::registerMutex(UserMutex *userMutex)
+{
+	if (!_reportStatistics)
+		return;
+
+	std::lock_guard<SpinLock> guard(_mutexesLock);
+	_mutexes.push_back(userMutex);
+}
+
+void UserMutex::printStatistics(std::ostream &stream) const
+{
+	const size_t handoffs = _acquisitions[HANDOFF_ACQUISITION];
+	const double blocked = std::max(handoffs, (size_t) 1);
+
+	stream << std::left << std::setw(20) << this << std::right
+		<< std::setw(12) << _acquisitions[FREE_ACQUISITION]
+		<< std::setw(12) << _acquisitions[SPIN_ACQUISITION]
+		<< std::setw(12) << handoffs
+		<< std::setw(12) << _maxBlockedTasks
+		<< std::setw(12) << std::fixed << std::setprecision(2) << _totalWaitTime / blocked
+		<< std::setw(12) << _maxWaitTime << std::endl;
+}
+
+void UserMutex::shutdown()
+{
+	if (!_reportStatistics)
+		return;
+
+	std::ostringstream report;
+	report << std::left << std::setw(20) << "User mutex" << std::right
+		<< std::setw(12) << "Free"
+		<< std::setw(12) << "Spin"
+		<< std::setw(12) << "Handoff"
+		<< std::setw(12) << "MaxBlocked"
+		<< std::setw(12) << "AvgWait(us)"
+		<< std::setw(12) << "MaxWait(us)" << std::endl;
+
+	std::lock_guard<SpinLock> guard(_mutexesLock);
+	for (UserMutex *userMutex : _mutexes) {
+		userMutex->printStatistics(report);
+	}
+
+	std::cerr << report.str();
+}
+
 
 void nanos6_user_lock(void **handlerPointer, __attribute__((unused)) char const *invocationSource)
 {
@@ -54,6 +151,7 @@ void nanos6_user_lock(void **handlerPointer, __attribute__((unused)) char const
 		if (userMutexReference.compare_exchange_strong(expected, newMutex)) {
 			// Successfully assigned new mutex
 			assert(userMutexReference == newMutex);
+			UserMutex::registerMutex(newMutex);
 
 			// Since we allocate the mutex in the locked state, the thread already owns it and the work is done
 			goto end;
@@ -73,22 +171,38 @@ void nanos6_user_lock(void **handlerPointer, __attribute__((unused)) char const
 
 	if (currentTask->isTaskfor()) {
 		// Lock the mutex directly
-		userMutex->spinLock();
+		if (userMutex->tryLock()) {
+			userMutex->registerAcquisition(UserMutex::FREE_ACQUISITION);
+		} else {
+			userMutex->spinLock();
+			userMutex->registerAcquisition(UserMutex::SPIN_ACQUISITION);
+		}
 	} else {
 		// Fast path
 		if (userMutex->tryLock()) {
+			userMutex->registerAcquisition(UserMutex::FREE_ACQUISITION);
+			goto end;
+		}
+
+		// Spin for a while, since short critical sections are usually
+		// released before blocking the task pays off
+		if (userMutex->trySpinLock()) {
+			userMutex->registerAcquisition(UserMutex::SPIN_ACQUISITION);
 			goto end;
 		}
 
 		// Acquire the lock if possible. Otherwise queue the task.
 		if (userMutex->lockOrQueue(currentTask)) {
 			// Successful
+			userMutex->registerAcquisition(UserMutex::FREE_ACQUISITION);
 			goto end;
 		}
 
 		Instrument::taskIsBlocked(currentTask->getInstrumentationTaskId(), Instrument::in_mutex_blocking_reason);
 		Instrument::blockedOnUserMutex(userMutex);
 
+		const uint64_t blockingTime = Chrono::now<uint64_t>();
+
 		TaskBlocking::taskBlocks(currentThread, currentTask);
 
 		// Update the CPU since the thread may have migrated
@@ -99,6 +213,9 @@ void nanos6_user_lock(void **handlerPointer, __attribute__((unused)) char const
 		// This in combination with a release from other threads makes their changes visible to this one
 		std::atomic_thread_fence(std::memory_order_acquire);
 
+		// The previous owner has passed the mutex to this task
+		userMutex->registerAcquisition(UserMutex::HANDOFF_ACQUISITION, Chrono::now<uint64_t>() - blockingTime);
+
 		Instrument::taskIsExecuting(currentTask->getInstrumentationTaskId(), true);
 	}
 
@@ -160,7 +277,10 @@ void nanos6_user_unlock(void **handlerPointer)
 				Instrument::ThreadInstrumentationContext::updateComputePlace(cpu->getInstrumentationId());
 			}
 		} else {
-			Scheduler::addReadyTask(releasedTask, cpu, UNBLOCKED_TASK_HINT);
+			// The released task already owns the mutex, so it should run as soon
+			// as possible, and preferably on this CPU, where the data protected
+			// by the mutex is likely cached
+			Scheduler::addReadyTask(releasedTask, cpu, HANDOFF_TASK_HINT);
 		}
 	}
 
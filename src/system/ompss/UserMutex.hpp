@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef USER_MUTEX_HPP
@@ -11,16 +11,39 @@
 #include "lowlevel/SpinLock.hpp"
 #include "lowlevel/SpinWait.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <deque>
 #include <mutex>
+#include <ostream>
 
 
 class Task;
 
 
+//! \brief A user-side mutex with handoff semantics
+//!
+//! When the owner unlocks the mutex and there are blocked tasks, the mutex
+//! is not released. Instead, the ownership is passed to the first blocked
+//! task, so tasks that try to lock it later cannot overtake the blocked ones
 class UserMutex {
+public:
+	enum acquisition_t {
+		//! The mutex was free
+		FREE_ACQUISITION = 0,
+		//! The mutex was acquired after spinning
+		SPIN_ACQUISITION,
+		//! The task blocked and received the mutex from the previous owner
+		HANDOFF_ACQUISITION
+	};
+
+private:
+	//! Limits of the number of spins before blocking
+	static constexpr size_t MIN_SPINS = 16;
+	static constexpr size_t MAX_SPINS = 4096;
+
 	//! \brief The user mutex state
 	std::atomic<bool> _userMutex;
 
@@ -30,13 +53,33 @@ class UserMutex {
 	//! \brief The list of tasks blocked on this user-side mutex
 	std::deque<Task *> _blockedTasks;
 
+	//! \brief The number of blocked tasks, which can be read without the lock
+	std::atomic<size_t> _numBlockedTasks;
+
+	//! \brief Average number of spins of the acquisitions that succeeded
+	//! spinning, which bounds the spinning of the next ones
+	std::atomic<size_t> _spinEstimate;
+
+	//! \brief Statistics, only updated by the owner of the mutex
+	size_t _acquisitions[3];
+	uint64_t _totalWaitTime;
+	uint64_t _maxWaitTime;
+
+	//! \brief Maximum number of blocked tasks, updated under the lock
+	size_t _maxBlockedTasks;
+
 public:
 	//! \brief Initialize the mutex
 	//!
 	//! \param[in] initialState true if the mutex must be initialized in the locked state
 	inline UserMutex(bool initialState)
-	: _userMutex(initialState), _blockedTasksLock(), _blockedTasks()
+	: _userMutex(initialState), _blockedTasksLock(), _blockedTasks(),
+		_numBlockedTasks(0), _spinEstimate(0), _acquisitions(),
+		_totalWaitTime(0), _maxWaitTime(0), _maxBlockedTasks(0)
 	{
+		if (initialState) {
+			_acquisitions[FREE_ACQUISITION]++;
+		}
 	}
 
 	//! \brief Try to lock
@@ -65,6 +108,38 @@ public:
 		}
 	}
 
+	//! \brief Spin for a while trying to grab the lock before blocking
+	//!
+	//! The number of spins adapts to the ones that were needed by the previous
+	//! acquisitions. Spinning stops when there are blocked tasks, since they
+	//! receive the mutex before the spinning ones
+	//!
+	//! \returns true if the lock has been acquired, false otherwise
+	inline bool trySpinLock()
+	{
+		const size_t estimate = _spinEstimate.load(std::memory_order_relaxed);
+		const size_t maxSpins = std::min(2 * estimate + MIN_SPINS, MAX_SPINS);
+
+		for (size_t spins = 0; spins < maxSpins; spins++) {
+			if (_numBlockedTasks.load(std::memory_order_relaxed) > 0)
+				break;
+
+			spinWait();
+
+			if (!_userMutex.load(std::memory_order_relaxed) && tryLock()) {
+				spinWaitRelease();
+
+				// We own the mutex, so nobody else updates the estimation
+				const long delta = ((long) spins - (long) estimate) / 8;
+				_spinEstimate.store((size_t) ((long) estimate + delta), std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		spinWaitRelease();
+		return false;
+	}
+
 	//! \brief Try to lock of queue the task
 	//!
 	//! \param[in] task The task that will be queued if the lock cannot be acquired
@@ -77,10 +152,15 @@ public:
 			return true;
 		} else {
 			_blockedTasks.push_back(task);
+			_numBlockedTasks.store(_blockedTasks.size(), std::memory_order_relaxed);
+			_maxBlockedTasks = std::max(_maxBlockedTasks, _blockedTasks.size());
 			return false;
 		}
 	}
 
+	//! \brief Unlock the mutex or pass its ownership to the first blocked task
+	//!
+	//! \returns The task that now owns the mutex, or nullptr if it has been unlocked
 	inline Task *dequeueOrUnlock()
 	{
 		std::lock_guard<SpinLock> guard(_blockedTasksLock);
@@ -92,10 +172,42 @@ public:
 
 		Task *releasedTask = _blockedTasks.front();
 		_blockedTasks.pop_front();
+		_numBlockedTasks.store(_blockedTasks.size(), std::memory_order_relaxed);
 		assert(releasedTask != nullptr);
 
 		return releasedTask;
 	}
+
+	//! \brief Record an acquisition of the mutex. Must be called by the owner
+	//!
+	//! \param[in] acquisition How the mutex was acquired
+	//! \param[in] waitTime The time that the task was blocked, in microseconds
+	inline void registerAcquisition(acquisition_t acquisition, uint64_t waitTime = 0)
+	{
+		assert(_userMutex.load(std::memory_order_relaxed));
+
+		_acquisitions[acquisition]++;
+		_totalWaitTime += waitTime;
+		_maxWaitTime = std::max(_maxWaitTime, waitTime);
+	}
+
+	//! \brief Add the runtime information entries of the statistics if requested
+	static void initialize();
+
+	//! \brief Refresh the runtime information entries of the statistics
+	//!
+	//! The counters are read while their owners may update them, so the
+	//! values are only exact when no user mutex is being acquired
+	static void updateRuntimeInfo();
+
+	//! \brief Register a mutex to report its statistics at shutdown
+	static void registerMutex(UserMutex *userMutex);
+
+	//! \brief Report the statistics of the mutexes if requested
+	static void shutdown();
+
+private:
+	void printStatistics(std::ostream &stream) const;
 };
 
 
@@ -7,12 +7,18 @@
 #ifndef STREAM_EXECUTOR_HPP
 #define STREAM_EXECUTOR_HPP
 
+#include <atomic>
 #include <deque>
+#include <mutex>
 #include <pthread.h>
 
+#include <boost/lockfree/queue.hpp>
+
 #include <nanos6.h>
 
+#include "MemoryAllocator.hpp"
 #include "lowlevel/ConditionVariable.hpp"
+#include "lowlevel/SpinLock.hpp"
 #include "system/BlockingAPI.hpp"
 #include "system/ompss/SpawnFunction.hpp"
 #include "system/ompss/TaskWait.hpp"
@@ -51,6 +57,8 @@ struct StreamFunction {
 	}
 };
 
+//! \brief The callback of a stream function that is called once all the
+//! tasks spawned by the function have finished
 struct StreamFunctionCallback {
 	void (*_callback)(void *);
 	void *_callbackArgs;
@@ -82,24 +90,161 @@ class StreamExecutor : public Task {
 
 private:
 
+	typedef boost::lockfree::queue<
+		StreamFunction *,
+		boost::lockfree::fixed_sized<true>,
+		boost::lockfree::allocator<TemplateAllocator<StreamFunction *>>
+	> function_queue_t;
+
+	//! The number of functions that fit in the lock-free queue
+	static constexpr size_t QUEUE_CAPACITY = 1024;
+
+	//! The maximum number of functions taken from the queues at once
+	static constexpr size_t BATCH_SIZE = 64;
+
 	//! The identifier of the stream this executor is in charge of
 	size_t _streamId;
 
-	//! Whether the executor task is blocked
-	bool _blocked;
+	//! Whether the executor task is blocked or about to block
+	std::atomic<bool> _blocked;
 
 	//! Whether the runtime is shutting down
 	std::atomic<bool> _mustShutdown;
 
-	//! The executor's function queue
-	std::deque<StreamFunction *> _queue;
+	//! The lock-free queue of functions of the stream. There may be many
+	//! producers but the executor is the only consumer
+	function_queue_t _queue;
 
-	//! A spinlock to access the queue and block/unblock the executor
-	SpinLock _spinlock;
+	//! The functions added while the lock-free queue was full. Once there
+	//! are functions in this queue, the new ones are also added here until
+	//! the executor takes them, so that the functions keep their order
+	std::deque<StreamFunction *> _overflowQueue;
 
-	//! Holds the callback of the function currently being executed
+	//! The number of functions in the overflow queue
+	std::atomic<size_t> _overflowSize;
+
+	//! A spinlock to access the overflow queue
+	SpinLock _overflowLock;
+
+	//! The function currently being executed
+	StreamFunction *_currentFunction;
+
+	//! The callback of the current function, which is only created once
+	//! the function spawns a task
 	StreamFunctionCallback *_currentCallback;
 
+	//! \brief Take the functions from the lock-free queue
+	//!
+	//! \param[in,out] functions The array where the functions are placed
+	//! \param[in] numFunctions The number of functions already in the array
+	//!
+	//! \returns The number of functions in the array
+	inline size_t popQueuedFunctions(StreamFunction **functions, size_t numFunctions)
+	{
+		while (numFunctions < BATCH_SIZE && _queue.pop(functions[numFunctions])) {
+			assert(functions[numFunctions] != nullptr);
+			++numFunctions;
+		}
+		return numFunctions;
+	}
+
+	//! \brief Take a batch of functions in the order they were added
+	//!
+	//! \param[out] functions An array of BATCH_SIZE functions
+	//!
+	//! \returns The number of functions taken
+	inline size_t popFunctions(StreamFunction **functions)
+	{
+		size_t numFunctions = popQueuedFunctions(functions, 0);
+
+		if (numFunctions < BATCH_SIZE && _overflowSize.load(std::memory_order_relaxed) > 0) {
+			std::lock_guard<SpinLock> guard(_overflowLock);
+
+			// The functions in the lock-free queue that were added before the
+			// ones in the overflow queue must be executed first
+			numFunctions = popQueuedFunctions(functions, numFunctions);
+			if (numFunctions < BATCH_SIZE) {
+				while (numFunctions < BATCH_SIZE && !_overflowQueue.empty()) {
+					functions[numFunctions++] = _overflowQueue.front();
+					_overflowQueue.pop_front();
+				}
+				_overflowSize.store(_overflowQueue.size(), std::memory_order_relaxed);
+			}
+		}
+
+		return numFunctions;
+	}
+
+	//! \brief Block the executor until there are functions to execute
+	//!
+	//! \param[out] functions An array of BATCH_SIZE functions
+	//!
+	//! \returns The number of functions taken after unblocking
+	inline size_t waitForFunctions(StreamFunction **functions)
+	{
+		assert(!_blocked.load());
+		_blocked.store(true, std::memory_order_relaxed);
+
+		// Either the executor sees the functions added concurrently or the
+		// producers see that the executor is blocking
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		size_t numFunctions = popFunctions(functions);
+		if (numFunctions == 0 && !_mustShutdown.load(std::memory_order_relaxed)) {
+			BlockingAPI::blockCurrentTask();
+		} else if (!_blocked.exchange(false)) {
+			// A producer has already seen the flag and is going to unblock
+			// the executor, so it must block anyway
+			BlockingAPI::blockCurrentTask();
+		}
+
+		return numFunctions;
+	}
+
+	//! \brief Unblock the executor if it is blocked or about to block
+	inline void unblockIfBlocked()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (_blocked.load(std::memory_order_relaxed) && _blocked.exchange(false)) {
+			BlockingAPI::unblockTask(this);
+		}
+	}
+
+	//! \brief Execute a batch of functions
+	//!
+	//! The callback of a function that does not spawn tasks is called right
+	//! after it without any allocation. Otherwise, the function has its own
+	//! callback object, which is called when the last of its tasks finishes,
+	//! so the callbacks never wait for the tasks of other functions
+	inline void executeFunctions(StreamFunction **functions, size_t numFunctions)
+	{
+		for (size_t i = 0; i < numFunctions; ++i) {
+			StreamFunction *function = functions[i];
+			assert(function != nullptr);
+			assert(_currentCallback == nullptr);
+
+			_currentFunction = function;
+
+			// Execute the function
+			function->_function(function->_args);
+
+			if (_currentCallback != nullptr) {
+				// Release the participation of the executor, which calls the
+				// callback if all the tasks of the function have finished
+				decreaseCallbackParticipants(_currentCallback);
+				_currentCallback = nullptr;
+			} else if (function->_callback != nullptr) {
+				function->_callback(function->_callbackArgs);
+			}
+
+			_currentFunction = nullptr;
+
+			// Delete the executed function
+			delete function;
+		}
+	}
+
 public:
 
 	inline StreamExecutor(
@@ -122,8 +267,11 @@ public:
 			taskStatistics),
 		_blocked(false),
 		_mustShutdown(false),
-		_queue(),
-		_spinlock(),
+		_queue(QUEUE_CAPACITY),
+		_overflowQueue(),
+		_overflowSize(0),
+		_overflowLock(),
+		_currentFunction(nullptr),
 		_currentCallback(nullptr)
 	{
 	}
@@ -152,38 +300,26 @@ public:
 	//! \brief Notify to the executor that it must be shutdown
 	inline void notifyShutdown()
 	{
-		_spinlock.lock();
-
 		_mustShutdown = true;
 
-		bool mustUnblock = _blocked;
-		_blocked = false;
-
-		_spinlock.unlock();
-
 		// Unblock the executor if it was blocked
-		if (mustUnblock) {
-			BlockingAPI::unblockTask(this);
-		}
+		unblockIfBlocked();
 	}
 
 	//! \brief Add a function to this executor's stream queue
 	//! \param[in] function The kernel to execute
 	inline void addFunction(StreamFunction *function)
 	{
-		_spinlock.lock();
+		assert(function != nullptr);
 
-		_queue.push_back(function);
-
-		bool mustUnblock = _blocked;
-		_blocked = false;
-
-		_spinlock.unlock();
+		if (_overflowSize.load(std::memory_order_relaxed) > 0 || !_queue.bounded_push(function)) {
+			std::lock_guard<SpinLock> guard(_overflowLock);
+			_overflowQueue.push_back(function);
+			_overflowSize.store(_overflowQueue.size(), std::memory_order_relaxed);
+		}
 
 		// Unblock the executor if it was blocked
-		if (mustUnblock) {
-			BlockingAPI::unblockTask(this);
-		}
+		unblockIfBlocked();
 	}
 
 	//! \brief Increase the number of participants in a callback. This is so
@@ -210,65 +346,45 @@ public:
 		}
 	}
 
-	//! \brief Return the callback of the function being currently executed
-	inline StreamFunctionCallback *getCurrentFunctionCallback() const
+	//! \brief Return the callback in which the tasks spawned by the function
+	//! being currently executed participate, if the function has a callback
+	inline StreamFunctionCallback *getCurrentFunctionCallback()
 	{
+		if (_currentFunction == nullptr || _currentFunction->_callback == nullptr)
+			return nullptr;
+
+		if (_currentCallback == nullptr) {
+			// The StreamExecutor participates in the duty of calling the
+			// callback until the function has returned
+			_currentCallback = new StreamFunctionCallback(
+				_currentFunction->_callback,
+				_currentFunction->_callbackArgs,
+				/* callbackParticipants = */ 1
+			);
+		}
+
 		return _currentCallback;
 	}
 
 	//! \brief The body of a stream executor
+	//!
+	//! The functions are executed in batches, so that each activation of the
+	//! executor runs as many functions as possible without blocking. At
+	//! shutdown, the executor finishes once its queues are empty
 	inline void body(nanos6_address_translation_entry_t * = nullptr) override
 	{
-		while (!_mustShutdown.load()) {
-			_spinlock.lock();
-
-			if (!_queue.empty()) {
-				// Get the first function in the stream's queue
-				StreamFunction *function = _queue.front();
-				assert(function != nullptr);
-				_queue.pop_front();
-
-				_spinlock.unlock();
-
-				// If a callback exists for the function about to be executed,
-				// register it in the map for a future trigger
-				if (function->_callback != nullptr) {
-					// The StreamExecutor in charge of the function participates
-					// in the duty of calling the callback, hence by default
-					// there's always one participant when creating callbacks
-					StreamFunctionCallback *callbackObject = new StreamFunctionCallback(
-						function->_callback,
-						function->_callbackArgs,
-						/* callbackParticipants = */ 1
-					);
-
-					_currentCallback = callbackObject;
-				}
+		StreamFunction *functions[BATCH_SIZE];
 
-				// Execute the function
-				function->_function(function->_args);
+		while (true) {
+			size_t numFunctions = popFunctions(functions);
+			if (numFunctions == 0) {
+				if (_mustShutdown.load())
+					break;
 
-				// Decrease the participants of the callback of the executed
-				// function, as this executor may need to execute the callback
-				// if all child tasks have finished or none were created
-				if (_currentCallback != nullptr) {
-					decreaseCallbackParticipants(_currentCallback);
-				}
-
-				// Reset the pointer to the current callback
-				_currentCallback = nullptr;
-
-				// Delete the executed function
-				delete function;
-			} else {
-				// Release the lock and block the task
-				assert(!_blocked);
-				_blocked = true;
-
-				_spinlock.unlock();
-
-				BlockingAPI::blockCurrentTask();
+				numFunctions = waitForFunctions(functions);
 			}
+
+			executeFunctions(functions, numFunctions);
 		}
 	}
 
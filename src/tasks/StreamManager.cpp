@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #include "StreamManager.hpp"
@@ -84,5 +84,5 @@ void StreamManager::synchronizeAllStreams()
 	}
 
 	// NOTE: The dynamically created StreamFunction-taskwaits are deleted upon
-	// completion by the appropriate StreamExecutor (see StreamExecutor::body)
+	// completion by the appropriate StreamExecutor (see StreamExecutor::executeFunctions)
 }
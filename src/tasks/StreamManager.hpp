@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef STREAM_MANAGER_HPP
@@ -12,6 +12,7 @@
 #include <nanos6.h>
 
 #include "StreamExecutor.hpp"
+#include "lowlevel/RWSpinLock.hpp"
 #include "system/ompss/AddTask.hpp"
 #include "system/ompss/SpawnFunction.hpp"
 #include "tasks/TaskImplementation.hpp"
@@ -29,8 +30,10 @@ private:
 	//! Maps stream executors through their stream identifier
 	stream_executors_t _executors;
 
-	//! Spinlock to add new stream executors and access existent ones
-	SpinLock _spinlock;
+	//! Lock to add new stream executors and access existent ones. The
+	//! executors are looked up each time a function is added, and they
+	//! are created only once, so the lookups share the lock
+	RWSpinLock _spinlock;
 
 	//! A static invocation info object for all Stream Executors
 	static nanos6_task_invocation_info_t _invocationInfo;
@@ -77,19 +80,29 @@ private:
 	//! \return A pointer to the stream executor in charge of streamId
 	StreamExecutor *findOrCreateExecutor(size_t streamId)
 	{
-		_spinlock.lock();
-
+		_spinlock.readLock();
 		StreamExecutor *executor = findExecutor(streamId);
+		_spinlock.readUnlock();
+
+		if (executor != nullptr) {
+			return executor;
+		}
+
+		_spinlock.writeLock();
 
+		// Check again since another thread may have created it
+		executor = findExecutor(streamId);
 		if (executor != nullptr) {
 			// Release the lock as it is no longer needed
-			_spinlock.unlock();
+			_spinlock.writeUnlock();
 			return executor;
 		}
 
 		// Executor's taskinfo
 		// Executor's args block
-		nanos6_task_info_t *executorInfo = (nanos6_task_info_t *) malloc(sizeof(nanos6_task_info_t));
+		// The executor's taskinfo is not registered, so the fields that are not
+		// filled in below, such as the tasktype data, must be null
+		nanos6_task_info_t *executorInfo = (nanos6_task_info_t *) calloc(1, sizeof(nanos6_task_info_t));
 		assert(executorInfo != nullptr);
 
 		// Fill in the executor's taskinfo
@@ -131,7 +144,7 @@ private:
 		_executors.emplace(std::make_pair(streamId, executor));
 
 		// Release the lock as it is no longer needed
-		_spinlock.unlock();
+		_spinlock.writeUnlock();
 
 		// Increase the number of active stream executors
 		++_activeStreamExecutors;
@@ -0,0 +1,113 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <new>
+
+#include "TaskAllocationCache.hpp"
+#include "TasktypeData.hpp"
+#include "executors/threads/CPU.hpp"
+#include "executors/threads/CPUManager.hpp"
+#include "executors/threads/WorkerThread.hpp"
+
+
+//! \brief Get the cache of a tasktype in the current CPU
+//!
+//! \param[in] tasktypeData The tasktype or nullptr
+//! \param[out] cpuId The index of the current CPU
+//!
+//! \returns The cache or nullptr if there is no tasktype or the current
+//! thread is not running on a CPU
+static inline TaskAllocationCache *getCurrentCache(TasktypeData *tasktypeData, size_t &cpuId)
+{
+	if (tasktypeData == nullptr) {
+		return nullptr;
+	}
+
+	WorkerThread *thread = WorkerThread::getCurrentWorkerThread();
+	if (thread == nullptr) {
+		return nullptr;
+	}
+
+	CPU *cpu = thread->getComputePlace();
+	if (cpu == nullptr) {
+		return nullptr;
+	}
+
+	cpuId = cpu->getIndex();
+
+	return &tasktypeData->getAllocationCache();
+}
+
+
+TaskAllocationCache::magazine_t *TaskAllocationCache::createMagazines()
+{
+	const size_t numCPUs = CPUManager::getTotalCPUs();
+	assert(numCPUs > 0);
+
+	magazine_t *magazines = (magazine_t *) MemoryAllocator::alloc(numCPUs * sizeof(magazine_t));
+	assert(magazines != nullptr);
+
+	for (size_t i = 0; i < numCPUs; ++i) {
+		new (&magazines[i]) magazine_t();
+	}
+
+	// Concurrent creators store the same value
+	_numMagazines.store(numCPUs, std::memory_order_relaxed);
+
+	magazine_t *expected = nullptr;
+	if (_magazines.compare_exchange_strong(expected, magazines, std::memory_order_acq_rel)) {
+		return magazines;
+	}
+
+	// Another CPU created them concurrently
+	MemoryAllocator::free(magazines, numCPUs * sizeof(magazine_t));
+	assert(expected != nullptr);
+
+	return expected;
+}
+
+TaskAllocationCache::~TaskAllocationCache()
+{
+	magazine_t *magazines = _magazines.load();
+	if (magazines == nullptr) {
+		return;
+	}
+
+	// Blocks are only returned if the allocator is still alive
+	if (MemoryAllocator::isInitialized()) {
+		const size_t numMagazines = _numMagazines.load();
+		for (size_t i = 0; i < numMagazines; ++i) {
+			Magazine &magazine = magazines[i];
+			for (size_t j = 0; j < magazine._numBlocks; ++j) {
+				MemoryAllocator::free(magazine._blocks[j], magazine._blockSize, /* useCPUPool */ true);
+			}
+		}
+
+		MemoryAllocator::free(magazines, numMagazines * sizeof(magazine_t));
+	}
+}
+
+void *TaskAllocationCache::allocateTaskBlock(TasktypeData *tasktypeData, size_t blockSize)
+{
+	size_t cpuId;
+	TaskAllocationCache *cache = getCurrentCache(tasktypeData, cpuId);
+	if (cache != nullptr) {
+		return cache->allocate(cpuId, blockSize);
+	}
+
+	return MemoryAllocator::alloc(blockSize, /* useCPUPool */ true);
+}
+
+void TaskAllocationCache::freeTaskBlock(TasktypeData *tasktypeData, void *block, size_t blockSize)
+{
+	size_t cpuId;
+	TaskAllocationCache *cache = getCurrentCache(tasktypeData, cpuId);
+	if (cache != nullptr) {
+		cache->deallocate(cpuId, block, blockSize);
+	} else {
+		MemoryAllocator::free(block, blockSize, /* useCPUPool */ true);
+	}
+}
@@ -0,0 +1,140 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef TASK_ALLOCATION_CACHE_HPP
+#define TASK_ALLOCATION_CACHE_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+#include "lowlevel/Padding.hpp"
+
+#include <MemoryAllocator.hpp>
+
+
+class TasktypeData;
+
+//! \brief Per-tasktype cache of task memory blocks
+//!
+//! The memory block of a task holds its args block, the task object, the
+//! data accesses and the space for hardware counters, monitoring statistics
+//! and constraints. Tasks of the same type usually have the same block size,
+//! so the blocks of disposed tasks are kept in a per-CPU magazine of their
+//! tasktype and handed out again when that CPU creates a task of the type.
+//! Each magazine holds blocks of a single size; blocks of other sizes and
+//! blocks that do not fit in a full magazine go back to the memory allocator.
+//!
+//! The magazine of a CPU is only accessed by the thread running on it, so it
+//! does not need any locking
+class TaskAllocationCache {
+private:
+	//! Maximum number of blocks cached per CPU
+	static constexpr size_t MAGAZINE_CAPACITY = 16;
+
+	struct Magazine {
+		size_t _blockSize;
+		size_t _numBlocks;
+		void *_blocks[MAGAZINE_CAPACITY];
+
+		Magazine() :
+			_blockSize(0),
+			_numBlocks(0)
+		{
+		}
+	};
+
+	typedef Padded<Magazine> magazine_t;
+
+	//! The per-CPU magazines, created on first use since task types may be
+	//! registered before the CPUs are known
+	std::atomic<magazine_t *> _magazines;
+
+	//! The number of magazines in _magazines
+	std::atomic<size_t> _numMagazines;
+
+	//! \brief Create the per-CPU magazines if nobody did it yet
+	magazine_t *createMagazines();
+
+	inline Magazine &getMagazine(size_t cpuId)
+	{
+		magazine_t *magazines = _magazines.load(std::memory_order_acquire);
+		if (magazines == nullptr) {
+			magazines = createMagazines();
+		}
+		assert(magazines != nullptr);
+		assert(cpuId < _numMagazines);
+
+		return magazines[cpuId];
+	}
+
+public:
+	inline TaskAllocationCache() :
+		_magazines(nullptr),
+		_numMagazines(0)
+	{
+	}
+
+	~TaskAllocationCache();
+
+	TaskAllocationCache(TaskAllocationCache const &) = delete;
+	TaskAllocationCache &operator=(TaskAllocationCache const &) = delete;
+
+	//! \brief Get a task block from the cache of a CPU or from the allocator
+	//!
+	//! \param[in] cpuId The index of the CPU that runs the caller
+	//! \param[in] blockSize The size of the whole task block
+	inline void *allocate(size_t cpuId, size_t blockSize)
+	{
+		Magazine &magazine = getMagazine(cpuId);
+		if (magazine._numBlocks > 0 && magazine._blockSize == blockSize) {
+			return magazine._blocks[--magazine._numBlocks];
+		}
+
+		return MemoryAllocator::alloc(blockSize, /* useCPUPool */ true);
+	}
+
+	//! \brief Keep a task block in the cache of a CPU or free it
+	//!
+	//! \param[in] cpuId The index of the CPU that runs the caller
+	//! \param[in] block The task block
+	//! \param[in] blockSize The size of the whole task block
+	inline void deallocate(size_t cpuId, void *block, size_t blockSize)
+	{
+		assert(block != nullptr);
+
+		Magazine &magazine = getMagazine(cpuId);
+		if (magazine._numBlocks == 0) {
+			magazine._blockSize = blockSize;
+		}
+
+		if (magazine._blockSize == blockSize && magazine._numBlocks < MAGAZINE_CAPACITY) {
+			magazine._blocks[magazine._numBlocks++] = block;
+		} else {
+			MemoryAllocator::free(block, blockSize, /* useCPUPool */ true);
+		}
+	}
+
+	//! \brief Allocate the memory block of a task
+	//!
+	//! The block is taken from the cache of the tasktype in the current CPU,
+	//! if any. Otherwise, it is allocated from the memory allocator
+	//!
+	//! \param[in] tasktypeData The tasktype of the task or nullptr if the
+	//! block must not be cached
+	//! \param[in] blockSize The size of the whole task block
+	static void *allocateTaskBlock(TasktypeData *tasktypeData, size_t blockSize);
+
+	//! \brief Free the memory block of a disposed task
+	//!
+	//! \param[in] tasktypeData The tasktype of the task or nullptr if the
+	//! block must not be cached
+	//! \param[in] block The task block
+	//! \param[in] blockSize The size of the whole task block
+	static void freeTaskBlock(TasktypeData *tasktypeData, void *block, size_t blockSize);
+};
+
+#endif // TASK_ALLOCATION_CACHE_HPP
@@ -1,13 +1,40 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
+#include <string>
+
 #include "Taskfor.hpp"
 #include "executors/threads/WorkerThread.hpp"
+#include "support/Chrono.hpp"
+#include "support/config/ConfigVariable.hpp"
+
 #include <InstrumentTaskExecution.hpp>
 
+
+Taskfor::schedule_t Taskfor::getConfiguredSchedule()
+{
+	static const schedule_t schedule = []() -> schedule_t {
+		ConfigVariable<std::string> scheduleName("taskfor.schedule");
+		const std::string &name = scheduleName.getValue();
+
+		if (name == "static") {
+			return STATIC_SCHEDULE;
+		} else if (name == "dynamic") {
+			return DYNAMIC_SCHEDULE;
+		} else if (name == "guided") {
+			return GUIDED_SCHEDULE;
+		} else if (name != "adaptive") {
+			FatalErrorHandler::fail("Unexistent '", name, "' taskfor schedule");
+		}
+		return ADAPTIVE_SCHEDULE;
+	}();
+
+	return schedule;
+}
+
 void Taskfor::run(Taskfor &source, nanos6_address_translation_entry_t *translationTable)
 {
 	assert(getParent()->isTaskfor() && getParent() == &source);
@@ -22,25 +49,36 @@ void Taskfor::run(Taskfor &source, nanos6_address_translation_entry_t *translati
 	MemoryPlace * const memoryPlace = cpu->getMemoryPlace(0);
 	source.setMemoryPlace(memoryPlace);
 
-	// Compute source taskfor total chunks
-	bounds_t const &sourceBounds = source.getBounds();
-	const size_t totalIterations = sourceBounds.upper_bound - sourceBounds.lower_bound;
-	const size_t totalChunks = MathSupport::ceil(totalIterations, sourceBounds.chunksize);
-
 	// Get the arguments and the task information
 	const nanos6_task_info_t &taskInfo = *getTaskInfo();
 	void *argsBlock = getArgsBlock();
-	size_t myIterations = computeChunkBounds(totalChunks, sourceBounds);
+
+	_bounds.lower_bound = _chunkLowerBound;
+	_bounds.upper_bound = _chunkUpperBound;
+	size_t myIterations = _chunkUpperBound - _chunkLowerBound;
 	assert(myIterations > 0);
 	size_t completedIterations = 0;
 
+	// Adaptive schedules size the chunks according to the time per iteration
+	TasktypeData *tasktypeData = nullptr;
+	if (source._schedule == ADAPTIVE_SCHEDULE && !source.isRemoteTask()) {
+		tasktypeData = source.getTasktypeData();
+	}
+
 	do {
+		const uint64_t startTime = (tasktypeData != nullptr) ? Chrono::now<uint64_t, std::nano>() : 0;
+
 		Instrument::taskforChunk(_myChunk);
 		taskInfo.implementations[0].run(argsBlock, &_bounds, translationTable);
 		Instrument::taskforChunk(-1);
 		// Prevent translating twice the addresses because the argsBlock is overwritten
 		translationTable = nullptr;
 
+		if (tasktypeData != nullptr) {
+			const uint64_t elapsed = Chrono::now<uint64_t, std::nano>() - startTime;
+			tasktypeData->getTasktypeStatistics().insertChunkTime(myIterations, elapsed);
+		}
+
 		completedIterations += myIterations;
 
 		// Stop after one chunk, to give the scheduler the opportunity to interrupt this
@@ -52,9 +90,9 @@ void Taskfor::run(Taskfor &source, nanos6_address_translation_entry_t *translati
 		// to ensure that the re-scheduling overhead is manageable.
 		break;
 
-		// _myChunk = source.getNextChunk(cpu);
+		// _myChunk = source.getNextChunk(cpu, _chunkLowerBound, _chunkUpperBound);
 		// if (_myChunk >= 0) {
-		// 	myIterations = computeChunkBounds(totalChunks, sourceBounds);
+		// 	myIterations = _chunkUpperBound - _chunkLowerBound;
 		// } else {
 		// 	myIterations = 0;
 		// }
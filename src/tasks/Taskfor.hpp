@@ -1,12 +1,13 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASKFOR_HPP
 #define TASKFOR_HPP
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -14,6 +15,7 @@
 #include "support/MathSupport.hpp"
 #include "tasks/Task.hpp"
 #include "tasks/TaskImplementation.hpp"
+#include "tasks/TasktypeData.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
 
 
@@ -21,9 +23,28 @@ class Taskfor : public Task {
 public:
 	typedef nanos6_loop_bounds_t bounds_t;
 
+	//! Ways of distributing the iterations of a taskfor among its collaborators
+	enum schedule_t {
+		//! Chunks of the same size, one per collaborator unless there is a chunksize
+		STATIC_SCHEDULE = 0,
+		//! Chunks of the same size, assigned in order
+		DYNAMIC_SCHEDULE,
+		//! Chunks that shrink with the remaining iterations, down to the chunksize
+		GUIDED_SCHEDULE,
+		//! Guided chunks that are not expected to last longer than a target time
+		ADAPTIVE_SCHEDULE
+	};
+
 private:
 	static const int PENDING_CHUNKS_SIZE=7;
 	static const int NUM_UINT64_BITS=64;
+
+	//! Chunks per collaborator of dynamic schedules without chunksize
+	static const size_t DYNAMIC_CHUNKS_PER_COLLABORATOR = 8;
+
+	//! Target duration of the chunks of adaptive schedules in nanoseconds
+	static const size_t ADAPTIVE_CHUNK_DURATION = 100000;
+
 	// Global counter of remaining chunks
 	std::atomic<int64_t> _remainingChunks;
 	// Array of size_t to complete a cache line, where each bit of each size_t represents a chunk
@@ -33,12 +54,26 @@ private:
 	std::atomic<uint64_t> _pendingChunks[PENDING_CHUNKS_SIZE];
 	// Source
 	Padded<std::atomic<size_t>> _remainingIterations;
+	// Source: the first iteration, relative to the lower bound, that has not
+	// been assigned to a chunk when chunks are not taken from _pendingChunks
+	std::atomic<size_t> _nextIteration;
+	// Source: the identifier of the next chunk assigned from _nextIteration
+	std::atomic<int> _nextChunk;
+	// Source: the schedule of the iterations
+	schedule_t _schedule;
+	// Source: whether chunks are assigned from _nextIteration
+	bool _useIterationCounter;
+	// Source: the number of collaborators of the group where chunks were initialized
+	size_t _numCollaborators;
 	// Source and collaborator
 	bounds_t _bounds;
 	// Collaborator
 	size_t _completedIterations;
 	// Collaborator
 	int _myChunk;
+	// Collaborator: the iterations of the chunk
+	size_t _chunkLowerBound;
+	size_t _chunkUpperBound;
 
 	size_t _initGroup;
 
@@ -65,9 +100,16 @@ public:
 			taskStatistics),
 		_remainingChunks(0),
 		_remainingIterations(),
+		_nextIteration(0),
+		_nextChunk(0),
+		_schedule(STATIC_SCHEDULE),
+		_useIterationCounter(false),
+		_numCollaborators(0),
 		_bounds(),
 		_completedIterations(0),
 		_myChunk(-1),
+		_chunkLowerBound(0),
+		_chunkUpperBound(0),
 		_initGroup(std::numeric_limits<size_t>::max())
 	{
 		assert(isFinal());
@@ -93,16 +135,11 @@ public:
 	{
 		assert(!isRunnable());
 
+		// Taskfors without iterations release their accesses without
+		// being scheduled. See ExecutionWorkflow::HostExecutionStep
 		_bounds.lower_bound = lowerBound;
-		_bounds.upper_bound = upperBound;
+		_bounds.upper_bound = std::max(upperBound, lowerBound);
 		_bounds.chunksize = chunksize;
-
-		// The current implementation hangs if the taskfor has no iterations.
-		FatalErrorHandler::failIf(upperBound <= lowerBound,
-								 "Task for ",
-								 getLabel(),
-								 " has no iterations: currently not supported");
-
 	}
 
 
@@ -123,6 +160,18 @@ public:
 
 		size_t totalIterations = getIterationCount();
 		_remainingIterations.store(totalIterations, std::memory_order_relaxed);
+		_numCollaborators = maxCollaborators;
+		_schedule = getConfiguredSchedule();
+
+		if (_schedule != STATIC_SCHEDULE) {
+			// The chunksize is the size of dynamic chunks and the minimum size of the rest
+			if (_schedule == DYNAMIC_SCHEDULE && _bounds.chunksize == 0) {
+				_bounds.chunksize = MathSupport::ceil(totalIterations, maxCollaborators * DYNAMIC_CHUNKS_PER_COLLABORATOR);
+			}
+			_bounds.chunksize = std::max(_bounds.chunksize, (size_t) 1);
+			_useIterationCounter = true;
+			return;
+		}
 
 		if (_bounds.chunksize == 0) {
 			// Just distribute iterations over collaborators if no hint.
@@ -139,8 +188,13 @@ public:
 		}
 
 		size_t totalChunks = MathSupport::ceil(totalIterations, _bounds.chunksize);
+		if (totalChunks > PENDING_CHUNKS_SIZE * NUM_UINT64_BITS) {
+			// The chunks do not fit in _pendingChunks, so assign them in order
+			_useIterationCounter = true;
+			return;
+		}
+
 		// Each bit of the _pendingChunks var represents a chunk. 1 is pending, 0 is already executed.
-		FatalErrorHandler::failIf(totalChunks > PENDING_CHUNKS_SIZE * NUM_UINT64_BITS, "Too many chunks required.");
 		_remainingChunks.store(totalChunks, std::memory_order_relaxed);
 		while (totalChunks > 0 ) {
 			int index = (totalChunks - 1) / NUM_UINT64_BITS;
@@ -187,11 +241,23 @@ public:
 		return (remaining == 0);
 	}
 
-	inline int getNextChunk(const CPU * const cpu, bool *remove = nullptr)
+	//! \brief Assign a chunk of iterations to a collaborator
+	//!
+	//! \param[in] cpu the CPU of the collaborator
+	//! \param[out] lowerBound the first iteration of the chunk
+	//! \param[out] upperBound the iteration after the last one of the chunk
+	//! \param[out] remove whether no chunks remain and the taskfor must be removed from the scheduler
+	//!
+	//! \returns the identifier of the chunk or -1 if there are no chunks left
+	inline int getNextChunk(const CPU * const cpu, size_t &lowerBound, size_t &upperBound, bool *remove = nullptr)
 	{
 		assert(!isRunnable());
 		assert(cpu != nullptr);
 
+		if (_useIterationCounter) {
+			return getNextCounterChunk(lowerBound, upperBound, remove);
+		}
+
 		// The chunksize was determined when the Taskfor was initialized,
 		// counting the number of CPUs (excluding the LeaderThread) on the
 		// TaskforGroup where it was initialized. But a taskfor may be
@@ -254,6 +320,13 @@ public:
 				if (fetched & ((uint64_t) 1 << chunkId)) {
 					chunkId += (NUM_UINT64_BITS * index);
 					assert(chunkId < (int) totalChunks);
+
+					// Invert to start from the beginning.
+					chunkId = totalChunks - (chunkId + 1);
+
+					lowerBound = _bounds.lower_bound + (chunkId * _bounds.chunksize);
+					upperBound = std::min(lowerBound + _bounds.chunksize, _bounds.upper_bound);
+					assert(lowerBound < upperBound);
 					return chunkId;
 				}
 			} while (1);
@@ -312,10 +385,13 @@ public:
 		return _bounds;
 	}
 
-	inline void setChunk(int chunk)
+	inline void setChunk(int chunk, size_t lowerBound, size_t upperBound)
 	{
 		assert(isRunnable());
+		assert(chunk < 0 || lowerBound < upperBound);
 		_myChunk = chunk;
+		_chunkLowerBound = lowerBound;
+		_chunkUpperBound = upperBound;
 	}
 
 	inline int getMyChunk() const
@@ -324,24 +400,6 @@ public:
 		return _myChunk;
 	}
 
-	inline size_t computeChunkBounds(size_t totalChunks, bounds_t const &sourceBounds)
-	{
-		assert(isRunnable());
-		assert(totalChunks > 0);
-
-		// Invert to start from the beginning.
-		_myChunk = totalChunks - (_myChunk + 1);
-		assert(_myChunk <= (int) totalChunks);
-		assert(_myChunk >= 0);
-
-		_bounds.lower_bound = sourceBounds.lower_bound + (_myChunk * sourceBounds.chunksize);
-		size_t myIterations = std::min(sourceBounds.chunksize, sourceBounds.upper_bound - _bounds.lower_bound);
-		assert(myIterations > 0 && myIterations <= sourceBounds.chunksize);
-		_bounds.upper_bound = _bounds.lower_bound + myIterations;
-
-		return myIterations;
-	}
-
 	inline size_t getCompletedIterations() const
 	{
 		assert(isRunnable());
@@ -389,8 +447,67 @@ public:
 	}
 
 private:
+	//! \brief Get the schedule chosen through the "taskfor.schedule" option
+	static schedule_t getConfiguredSchedule();
+
 	void run(Taskfor &source, nanos6_address_translation_entry_t *translationTable);
 
+	//! \brief Get the number of iterations of the next chunk when chunks are
+	//! assigned in order
+	//!
+	//! \param[in] remainingIterations the number of iterations not assigned yet
+	inline size_t computeChunkIterations(size_t remainingIterations) const
+	{
+		assert(_bounds.chunksize > 0);
+
+		if (_schedule == STATIC_SCHEDULE || _schedule == DYNAMIC_SCHEDULE) {
+			return _bounds.chunksize;
+		}
+
+		// Give each collaborator a half of its share of the remaining iterations
+		size_t iterations = std::max(MathSupport::ceil(remainingIterations, 2 * _numCollaborators), _bounds.chunksize);
+
+		if (_schedule == ADAPTIVE_SCHEDULE && !isRemoteTask()) {
+			TasktypeData *tasktypeData = getTasktypeData();
+			if (tasktypeData != nullptr) {
+				const double iterationTime = tasktypeData->getTasktypeStatistics().getChunkIterationTime();
+				if (iterationTime > 0.0) {
+					const size_t targetIterations = (size_t) (ADAPTIVE_CHUNK_DURATION / iterationTime);
+					iterations = std::min(iterations, std::max(targetIterations, _bounds.chunksize));
+				}
+			}
+		}
+
+		return iterations;
+	}
+
+	//! \brief Assign the next iterations of the taskfor to a chunk
+	inline int getNextCounterChunk(size_t &lowerBound, size_t &upperBound, bool *remove)
+	{
+		const size_t totalIterations = getIterationCount();
+		size_t first = _nextIteration.load(std::memory_order_relaxed);
+		size_t iterations;
+
+		do {
+			if (first >= totalIterations) {
+				if (remove != nullptr)
+					*remove = true;
+
+				return -1;
+			}
+
+			iterations = std::min(computeChunkIterations(totalIterations - first), totalIterations - first);
+		} while (!_nextIteration.compare_exchange_weak(first, first + iterations, std::memory_order_relaxed));
+
+		if (remove != nullptr)
+			*remove = (first + iterations == totalIterations);
+
+		lowerBound = _bounds.lower_bound + first;
+		upperBound = lowerBound + iterations;
+
+		return _nextChunk.fetch_add(1, std::memory_order_relaxed);
+	}
+
 	static inline size_t closestMultiple(size_t n, size_t multipleOf)
 	{
 		return ((n + multipleOf - 1) / multipleOf) * multipleOf;
@@ -1,12 +1,13 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASKLOOP_HPP
 #define TASKLOOP_HPP
 
+#include <algorithm>
 #include <cmath>
 
 #include "support/MathSupport.hpp"
@@ -76,7 +77,7 @@ public:
 	inline void initialize(size_t lowerBound, size_t upperBound, size_t grainsize, size_t chunksize)
 	{
 		_bounds.lower_bound = lowerBound;
-		_bounds.upper_bound = upperBound;
+		_bounds.upper_bound = std::max(upperBound, lowerBound);
 		_bounds.grainsize = grainsize;
 		_bounds.chunksize = chunksize;
 		_source = true;
@@ -101,8 +102,10 @@ public:
 
 	inline void registerDependencies(bool discrete = false) override
 	{
-		if (discrete && isTaskloopSource()) {
-			bounds_t tmpBounds;
+		// Taskloops without iterations register the dependencies of a
+		// single child with empty bounds, which still orders them
+		if (discrete && isTaskloopSource() && getIterationCount() > 0) {
+			bounds_t tmpBounds = _bounds;
 			calculateGrainsize(_bounds);
 			size_t numTasks = computeNumTasks(getIterationCount(), _bounds.grainsize);
 			for (size_t t = 0; t < numTasks; t++) {
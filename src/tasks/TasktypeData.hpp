@@ -1,13 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASKTYPE_DATA_HPP
 #define TASKTYPE_DATA_HPP
 
 #include "InstrumentTasktypeData.hpp"
+#include "TaskAllocationCache.hpp"
 #include "monitoring/TasktypeStatistics.hpp"
 
 
@@ -23,11 +24,15 @@ private:
 	//! Monitoring-related statistics per tasktype
 	TasktypeStatistics _tasktypeStatistics;
 
+	//! Cache of memory blocks of disposed tasks of this tasktype
+	TaskAllocationCache _allocationCache;
+
 public:
 
 	inline TasktypeData() :
 		_instrumentId(),
-		_tasktypeStatistics()
+		_tasktypeStatistics(),
+		_allocationCache()
 	{
 	}
 
@@ -41,6 +46,11 @@ public:
 		return _tasktypeStatistics;
 	}
 
+	inline TaskAllocationCache &getAllocationCache()
+	{
+		return _allocationCache;
+	}
+
 };
 
 #endif // TASKTYPE_DATA_HPP
@@ -0,0 +1,102 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/debug.h>
+#include <nanos6/runtime-info.h>
+
+#include <atomic>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_TASKS 2000
+#define LONG_SECTION_PERIOD 50
+
+// Longer than the maximum spinning, so that the waiting tasks block
+#define LONG_SECTION_MICROSECONDS 2000
+
+
+TestAnyProtocolProducer tap;
+
+static std::atomic<int> inside(0);
+static bool exclusive = true;
+static long counter = 0;
+
+
+//! \brief Get the value of an integer runtime information entry, or -1 if it does not exist
+static long getRuntimeInfo(char const *name)
+{
+	for (void *it = nanos6_runtime_info_begin(); it != nanos6_runtime_info_end(); it = nanos6_runtime_info_advance(it)) {
+		nanos6_runtime_info_entry_t entry;
+		nanos6_runtime_info_get(it, &entry);
+
+		if (strcmp(entry.name, name) == 0) {
+			return entry.integer;
+		}
+	}
+	return -1;
+}
+
+
+int main()
+{
+	tap.registerNewTests(5);
+	tap.begin();
+
+	// Most critical sections are short, so tasks usually get the mutex while
+	// spinning. Some of them are long enough for the other tasks to block and
+	// receive the mutex from its previous owner
+	for (int t = 0; t < NUM_TASKS; ++t) {
+		#pragma oss task firstprivate(t)
+		{
+			#pragma oss critical
+			{
+				if (++inside != 1) {
+					exclusive = false;
+				}
+
+				counter++;
+				if (t % LONG_SECTION_PERIOD == 0) {
+					usleep(LONG_SECTION_MICROSECONDS);
+				}
+
+				inside--;
+			}
+		}
+	}
+	#pragma oss taskwait
+
+	tap.evaluate(exclusive, "Only one task was inside the critical section at a time");
+	tap.evaluate(counter == NUM_TASKS, "All the critical sections were executed");
+
+	// The test runs with misc.mutex_statistics enabled
+	const long freeAcquisitions = getRuntimeInfo("mutex_free_acquisitions");
+	const long spinAcquisitions = getRuntimeInfo("mutex_spin_acquisitions");
+	const long handoffAcquisitions = getRuntimeInfo("mutex_handoff_acquisitions");
+	if (freeAcquisitions < 0 || spinAcquisitions < 0 || handoffAcquisitions < 0) {
+		tap.bailOut("The mutex statistics are not enabled");
+		return 1;
+	}
+
+	tap.emitDiagnostic("Free: ", freeAcquisitions, ", spin: ", spinAcquisitions, ", handoff: ", handoffAcquisitions);
+	tap.evaluate(freeAcquisitions + spinAcquisitions + handoffAcquisitions == NUM_TASKS,
+		"The statistics account for every acquisition");
+
+	// With a single CPU the tasks run one after the other, so the mutex is never contended
+	if (nanos6_get_num_cpus() > 1) {
+		tap.evaluate(spinAcquisitions > 0, "Some tasks acquired the mutex while spinning");
+		tap.evaluate(handoffAcquisitions > 0, "Some tasks blocked and received the mutex from its owner");
+	} else {
+		tap.skip("The mutex is not contended with a single CPU");
+		tap.skip("The mutex is not contended with a single CPU");
+	}
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,75 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+#include <vector>
+
+#include <unistd.h>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define N 64
+#define DELAY_MICROSECONDS 50000
+
+
+TestAnyProtocolProducer tap;
+
+
+int main()
+{
+	std::atomic<int> executed(0);
+	std::vector<int> nonpod(N, 1);
+	int data[N];
+	int value = 0;
+	int empty = 0;
+	bool ordered = false;
+
+	tap.registerNewTests(2);
+	tap.begin();
+
+	// Taskloops without iterations, without dependencies, with inverted
+	// bounds and with an args block that has to be destroyed
+	#pragma oss taskloop shared(executed)
+	for (int i = 0; i < empty; ++i) {
+		executed++;
+	}
+
+	#pragma oss taskloop shared(executed) grainsize(4)
+	for (int i = N; i < empty; ++i) {
+		executed++;
+	}
+
+	#pragma oss taskloop firstprivate(nonpod) shared(executed)
+	for (int i = 0; i < empty; ++i) {
+		executed += nonpod[i];
+	}
+
+	// A taskloop without iterations but with dependencies is still
+	// ordered between its predecessors and its successors
+	#pragma oss task out(value)
+	{
+		usleep(DELAY_MICROSECONDS);
+		value = 1;
+	}
+
+	#pragma oss taskloop inout(value) in(data[i]) shared(executed)
+	for (int i = 0; i < empty; ++i) {
+		executed++;
+		value = data[i];
+	}
+
+	#pragma oss task in(value) shared(ordered)
+	ordered = (value == 1);
+
+	#pragma oss taskwait
+
+	tap.evaluate(executed == 0, "The taskloops without iterations did not run any iteration");
+	tap.evaluate(ordered, "The dependencies around the empty taskloop were honored");
+	tap.end();
+
+	return 0;
+}
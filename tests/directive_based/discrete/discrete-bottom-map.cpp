@@ -0,0 +1,193 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "TestAnyProtocolProducer.hpp"
+
+// Built with the sources of the runtime in the include path
+#include "dependencies/discrete/BottomMap.hpp"
+
+
+#define INITIAL_CAPACITY 16
+#define NUM_COLLIDING 6
+#define NUM_ADDRESSES 10000
+#define NUM_OPERATIONS 200000
+#define NUM_RANDOM_ADDRESSES 2000
+
+
+// The runtime keeps these symbols hidden, so the test provides its own
+SpinLock FatalErrorHandler::_errorLock;
+SpinLock FatalErrorHandler::_infoLock;
+
+void FatalErrorHandler::nanos6Abort()
+{
+	abort();
+}
+
+std::string FatalErrorHandler::getErrorPrefix()
+{
+	return "";
+}
+
+namespace ompss_debug {
+	void *getCurrentThread()
+	{
+		return nullptr;
+	}
+}
+
+
+TestAnyProtocolProducer tap;
+
+struct Entry {
+	long _value;
+
+	Entry(long value) :
+		_value(value)
+	{
+	}
+};
+
+typedef BottomMap<Entry> map_t;
+
+
+//! \brief Get the first slot of an address in a table with INITIAL_CAPACITY
+//! slots, with the same hash as the map
+static size_t getFirstSlot(void *address)
+{
+	const int hashBits = __builtin_ctzl(INITIAL_CAPACITY);
+	return (size_t) (((uint64_t) (uintptr_t) address * 11400714819323198485ULL) >> (64 - hashBits));
+}
+
+//! \brief Get addresses that start probing at the same slot
+static std::vector<void *> getCollidingAddresses(size_t slot)
+{
+	std::vector<void *> addresses;
+	for (uintptr_t address = 8; addresses.size() < NUM_COLLIDING; address += 8) {
+		if (getFirstSlot((void *) address) == slot) {
+			addresses.push_back((void *) address);
+		}
+	}
+	return addresses;
+}
+
+static bool contains(map_t const &map, void *address, long value)
+{
+	map_t::iterator it = map.find(address);
+	return (it != map.end() && it->first == address && it->second._value == value);
+}
+
+static bool containsAll(map_t const &map, std::vector<void *> const &addresses, size_t except)
+{
+	for (size_t i = 0; i < addresses.size(); ++i) {
+		if (i != except && !contains(map, addresses[i], (long) i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//! \brief Remove entries from the middle of probe sequences, including one
+//! that wraps around the end of the table
+static void testCollisions()
+{
+	for (size_t slot : {(size_t) 3, (size_t) INITIAL_CAPACITY - 1}) {
+		std::vector<void *> addresses = getCollidingAddresses(slot);
+
+		map_t map;
+		for (size_t i = 0; i < addresses.size(); ++i) {
+			map.emplace(addresses[i], (long) i);
+		}
+
+		bool correct = (map.size() == NUM_COLLIDING) && containsAll(map, addresses, NUM_COLLIDING);
+		correct = correct && !map.emplace(addresses[0], 100L).second && contains(map, addresses[0], 0);
+
+		// Remove the second entry of the probe sequence
+		correct = correct && (map.erase(addresses[1]) == 1) && (map.erase(addresses[1]) == 0);
+		correct = correct && (map.find(addresses[1]) == map.end());
+		correct = correct && (map.size() == NUM_COLLIDING - 1) && containsAll(map, addresses, 1);
+
+		std::ostringstream oss;
+		oss << "Colliding addresses starting at slot " << slot << " are found after removing one of them";
+		tap.evaluate(correct, oss.str());
+	}
+}
+
+
+//! \brief Insert enough addresses to grow the table several times
+static void testRehash()
+{
+	map_t map;
+	std::vector<void *> addresses;
+	for (size_t i = 0; i < NUM_ADDRESSES; ++i) {
+		addresses.push_back((void *) (uintptr_t) (64 * (i + 1)));
+		map.emplace(addresses.back(), (long) i);
+	}
+	tap.evaluate(map.size() == NUM_ADDRESSES && containsAll(map, addresses, NUM_ADDRESSES),
+		"All the addresses are found after growing the table");
+
+	size_t iterated = 0;
+	for (map_t::iterator it = map.begin(); it != map.end(); ++it) {
+		iterated++;
+	}
+	tap.evaluate(iterated == NUM_ADDRESSES, "The iteration visits every entry once");
+
+	map.clear();
+	bool correct = map.empty() && (map.begin() == map.end()) && (map.find(addresses[0]) == map.end());
+	correct = correct && map.emplace(addresses[0], 7L).second && contains(map, addresses[0], 7);
+	tap.evaluate(correct, "The map is empty after clearing it and can be reused");
+}
+
+
+//! \brief Compare random insertions and removals with a standard map
+static void testRandomOperations()
+{
+	std::mt19937 generator(11);
+	std::uniform_int_distribution<int> addressDistribution(1, NUM_RANDOM_ADDRESSES);
+
+	map_t map;
+	std::unordered_map<void *, long> reference;
+
+	bool correct = true;
+	for (long op = 0; correct && op < NUM_OPERATIONS; ++op) {
+		void *address = (void *) (uintptr_t) (8 * addressDistribution(generator));
+
+		if (generator() % 2 == 0) {
+			const bool inserted = map.emplace(address, op).second;
+			correct = (inserted == reference.emplace(address, op).second);
+		} else {
+			correct = (map.erase(address) == reference.erase(address));
+		}
+
+		correct = correct && (map.size() == reference.size());
+	}
+
+	for (auto const &entry : reference) {
+		correct = correct && contains(map, entry.first, entry.second);
+	}
+	tap.evaluate(correct, "Random insertions and removals match a standard map");
+}
+
+
+int main()
+{
+	tap.registerNewTests(6);
+	tap.begin();
+
+	testCollisions();
+	testRehash();
+	testRandomOperations();
+
+	tap.end();
+
+	return 0;
+}
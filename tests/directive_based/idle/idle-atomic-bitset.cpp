@@ -0,0 +1,144 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "TestAnyProtocolProducer.hpp"
+
+// Built with the sources of the runtime in the include path
+#include "support/bitset/AtomicBitset.hpp"
+
+
+#define NUM_BITS 1000
+#define NUM_THREADS 4
+#define MAX_COUNT 7
+
+
+TestAnyProtocolProducer tap;
+
+
+static void testTestAndReset()
+{
+	AtomicBitset<> bitset(NUM_BITS);
+	bitset.set(0);
+	bitset.set(64);
+	bitset.set(NUM_BITS - 1);
+
+	bool correct = bitset.testAndReset(0) && bitset.testAndReset(64) && bitset.testAndReset(NUM_BITS - 1);
+	tap.evaluate(correct, "testAndReset obtains the set bits");
+
+	correct = !bitset.testAndReset(0) && !bitset.testAndReset(1) && bitset.none();
+	tap.evaluate(correct, "testAndReset does not obtain bits that are not set");
+}
+
+static void testResetMatching()
+{
+	AtomicBitset<> bitset(NUM_BITS);
+	for (size_t i = 0; i < NUM_BITS; ++i) {
+		bitset.set(i);
+	}
+
+	// Obtain the even bits in groups of at most MAX_COUNT
+	std::vector<int> obtained(NUM_BITS, 0);
+	size_t total = 0;
+	size_t count;
+	bool boundedCounts = true;
+	do {
+		count = bitset.resetMatching(MAX_COUNT,
+			[](size_t pos) { return (pos % 2 == 0); },
+			[&](size_t pos) { obtained[pos]++; }
+		);
+		boundedCounts = boundedCounts && (count <= MAX_COUNT);
+		total += count;
+	} while (count > 0);
+
+	tap.evaluate(boundedCounts, "resetMatching does not exceed the maximum amount of bits");
+
+	bool correct = (total == NUM_BITS / 2);
+	for (size_t i = 0; i < NUM_BITS; ++i) {
+		const int expected = (i % 2 == 0) ? 1 : 0;
+		correct = correct && (obtained[i] == expected);
+	}
+	tap.evaluate(correct, "resetMatching obtains every matching bit once");
+
+	// The bits that did not match are still set
+	correct = true;
+	for (size_t i = 0; i < NUM_BITS; ++i) {
+		correct = correct && (bitset.testAndReset(i) == (i % 2 == 1));
+	}
+	tap.evaluate(correct && bitset.none(), "resetMatching keeps the bits that do not match");
+}
+
+static void testConcurrentResetMatching()
+{
+	AtomicBitset<> bitset(NUM_BITS);
+	for (size_t i = 0; i < NUM_BITS; ++i) {
+		bitset.set(i);
+	}
+
+	// Several threads obtain bits concurrently, and one of them also with testAndReset
+	std::vector<std::atomic<int>> obtained(NUM_BITS);
+	for (std::atomic<int> &counter : obtained) {
+		counter = 0;
+	}
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < NUM_THREADS; ++t) {
+		threads.emplace_back([&, t]() {
+			bool found = true;
+			while (found) {
+				found = false;
+				if (t == 0) {
+					for (size_t i = 0; i < NUM_BITS; ++i) {
+						if (bitset.testAndReset(i)) {
+							obtained[i]++;
+							found = true;
+							break;
+						}
+					}
+				} else {
+					found = bitset.resetMatching(MAX_COUNT,
+						[](size_t) { return true; },
+						[&](size_t pos) { obtained[pos]++; }
+					) > 0;
+				}
+			}
+		});
+	}
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	size_t repeated = 0;
+	size_t missing = 0;
+	for (size_t i = 0; i < NUM_BITS; ++i) {
+		repeated += (obtained[i] > 1);
+		missing += (obtained[i] == 0);
+	}
+
+	std::ostringstream oss;
+	oss << "Concurrent calls obtain every bit exactly once (" << repeated << " repeated, " << missing << " missing)";
+	tap.evaluate(repeated == 0 && missing == 0 && bitset.none(), oss.str());
+}
+
+
+int main()
+{
+	tap.registerNewTests(6);
+	tap.begin();
+
+	testTestAndReset();
+	testResetMatching();
+	testConcurrentResetMatching();
+
+	tap.end();
+
+	return 0;
+}
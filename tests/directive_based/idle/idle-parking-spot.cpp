@@ -0,0 +1,106 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+#include "TestAnyProtocolProducer.hpp"
+
+// Built with the sources of the runtime in the include path
+#include "lowlevel/ParkingSpot.hpp"
+
+
+#define NUM_ROUNDS 100000
+
+
+// The runtime keeps these symbols hidden, so the test provides its own
+SpinLock FatalErrorHandler::_errorLock;
+SpinLock FatalErrorHandler::_infoLock;
+
+void FatalErrorHandler::nanos6Abort()
+{
+	abort();
+}
+
+std::string FatalErrorHandler::getErrorPrefix()
+{
+	return "";
+}
+
+namespace ompss_debug {
+	void *getCurrentThread()
+	{
+		return nullptr;
+	}
+}
+
+
+TestAnyProtocolProducer tap;
+
+
+static void testPendingUnpark()
+{
+	ParkingSpot spot;
+	tap.evaluate(!spot.isUnparkPending(), "A new parking spot has no pending unpark");
+
+	// An unpark before the park is kept, so the park returns at once
+	spot.unpark();
+	tap.evaluate(spot.isUnparkPending(), "An unpark without a parked thread is kept pending");
+	spot.park();
+	tap.evaluate(!spot.isUnparkPending(), "Parking consumes the pending unpark");
+
+	spot.unpark();
+	spot.clearPendingUnpark();
+	tap.evaluate(!spot.isUnparkPending(), "A pending unpark can be discarded");
+}
+
+static void testPingPong()
+{
+	ParkingSpot spots[2];
+	std::atomic<int> turn(0);
+	std::atomic<int> outOfTurn(0);
+
+	// Each thread parks until the other one passes it the turn. Some unparks
+	// arrive before the park and some after, so both orders are exercised
+	auto player = [&](int id) {
+		for (int round = 0; round < NUM_ROUNDS; ++round) {
+			if (id == 1 || round > 0) {
+				spots[id].park();
+			}
+			if (turn.load() != id) {
+				outOfTurn++;
+			}
+			turn.store(1 - id);
+			spots[1 - id].unpark();
+		}
+	};
+
+	std::thread other(player, 1);
+	player(0);
+	other.join();
+
+	// The last unpark of the second thread is left pending
+	spots[0].park();
+
+	std::ostringstream oss;
+	oss << "Two threads pass the turn " << NUM_ROUNDS << " times without lost or spurious wake-ups (" << outOfTurn << " out of turn)";
+	tap.evaluate(outOfTurn == 0 && !spots[0].isUnparkPending() && !spots[1].isUnparkPending(), oss.str());
+}
+
+
+int main()
+{
+	tap.registerNewTests(5);
+	tap.begin();
+
+	testPendingUnpark();
+	testPingPong();
+
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,208 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "TestAnyProtocolProducer.hpp"
+
+// Built with the sources of the runtime in the include path
+#include "dependencies/linear-regions/FlatRegionIndex.hpp"
+
+
+#define MAX_VALUES 100
+#define NUM_REGIONS 1000
+#define REGION_STRIDE 64
+
+
+TestAnyProtocolProducer tap;
+
+
+struct Entry {
+	DataAccessRegion _region;
+
+	Entry(DataAccessRegion const &region) :
+		_region(region)
+	{
+	}
+
+	DataAccessRegion const &getAccessRegion() const
+	{
+		return _region;
+	}
+};
+
+typedef FlatRegionIndex<Entry> index_t;
+typedef size_t (*count_function_t)(uintptr_t const *values, size_t count, uintptr_t address);
+
+
+//! \brief Check a count against the scalar one with sorted arrays of every
+//! length up to MAX_VALUES, including addresses with the highest bit set
+static bool checkCount(count_function_t countFunction)
+{
+	std::mt19937_64 generator(42);
+	std::vector<uintptr_t> values;
+
+	for (size_t count = 0; count <= MAX_VALUES; ++count) {
+		values.clear();
+		for (size_t i = 0; i < count; ++i) {
+			uintptr_t value = generator();
+			// Keep some small values and some duplicates
+			if (i % 3 == 0) {
+				value %= 1024;
+			} else if (i % 7 == 0 && i > 0) {
+				value = values[i - 1];
+			}
+			values.push_back(value);
+		}
+		std::sort(values.begin(), values.end());
+
+		std::vector<uintptr_t> addresses = {0, 1, 512, UINTPTR_MAX, (uintptr_t) 1 << 63, ((uintptr_t) 1 << 63) - 1};
+		for (uintptr_t value : values) {
+			addresses.push_back(value);
+			addresses.push_back(value - 1);
+			addresses.push_back(value + 1);
+		}
+
+		for (uintptr_t address : addresses) {
+			size_t expected = index_t::countNotAboveScalar(values.data(), count, address);
+			if (countFunction(values.data(), count, address) != expected) {
+				tap.emitDiagnostic("Wrong count of ", count, " values for address ", address);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+static void testCounts()
+{
+	// The scalar count is the reference, so check it against a plain search
+	bool correct = true;
+	std::vector<uintptr_t> values;
+	for (size_t i = 0; i < MAX_VALUES; ++i) {
+		values.push_back(i * 2);
+	}
+	for (uintptr_t address = 0; address < 2 * MAX_VALUES + 2; ++address) {
+		size_t expected = std::upper_bound(values.begin(), values.end(), address) - values.begin();
+		correct = correct && (index_t::countNotAboveScalar(values.data(), values.size(), address) == expected);
+	}
+	tap.evaluate(correct, "The scalar count matches a binary search");
+
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2")) {
+		tap.evaluate(checkCount(index_t::countNotAboveAVX2), "The AVX2 count matches the scalar one");
+	} else {
+		tap.skip("The CPU does not support AVX2");
+	}
+
+	if (__builtin_cpu_supports("avx512f")) {
+		tap.evaluate(checkCount(index_t::countNotAboveAVX512), "The AVX-512 count matches the scalar one");
+	} else {
+		tap.skip("The CPU does not support AVX-512");
+	}
+#else
+	tap.skip("The AVX2 count is only available in x86-64");
+	tap.skip("The AVX-512 count is only available in x86-64");
+#endif
+}
+
+
+//! \brief Check that the index finds the same entries as a linear search
+static bool checkLookups(index_t const &index, std::vector<Entry *> const &entries)
+{
+	std::mt19937_64 generator(7);
+	const uintptr_t limit = (NUM_REGIONS + 1) * REGION_STRIDE;
+
+	for (int query = 0; query < 2000; ++query) {
+		uintptr_t start = generator() % limit;
+		uintptr_t length = generator() % (4 * REGION_STRIDE) + 1;
+		DataAccessRegion region((void *) start, (size_t) length);
+
+		std::vector<Entry *> expected;
+		for (Entry *entry : entries) {
+			if (!entry->getAccessRegion().intersect(region).empty()) {
+				expected.push_back(entry);
+			}
+		}
+		std::sort(expected.begin(), expected.end(),
+			[](Entry *a, Entry *b) {
+				return a->getAccessRegion().getStartAddress() < b->getAccessRegion().getStartAddress();
+			}
+		);
+
+		std::vector<Entry *> found;
+		index.processIntersecting(region,
+			[&](Entry *entry) -> bool {
+				found.push_back(entry);
+				return true;
+			}
+		);
+
+		if (found != expected) {
+			tap.emitDiagnostic("Wrong entries for region ", region);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void testIndex()
+{
+	// Disjoint regions with gaps between them, inserted in random order. There
+	// are more than the scan threshold so that the lookups also bisect
+	std::vector<Entry> storage;
+	storage.reserve(NUM_REGIONS);
+	for (size_t i = 0; i < NUM_REGIONS; ++i) {
+		uintptr_t start = (i + 1) * REGION_STRIDE;
+		storage.emplace_back(DataAccessRegion((void *) start, (size_t) (REGION_STRIDE / 2 + i % (REGION_STRIDE / 2))));
+	}
+
+	std::vector<Entry *> entries;
+	for (Entry &entry : storage) {
+		entries.push_back(&entry);
+	}
+	std::shuffle(entries.begin(), entries.end(), std::mt19937(3));
+
+	index_t index;
+	for (Entry *entry : entries) {
+		index.insert(entry);
+	}
+	tap.evaluate(index.size() == NUM_REGIONS, "The index contains all the inserted regions");
+	tap.evaluate(checkLookups(index, entries), "The lookups find the intersecting regions in order");
+
+	// Erase half of them
+	for (size_t i = 0; i < NUM_REGIONS / 2; ++i) {
+		index.erase(entries.back());
+		entries.pop_back();
+	}
+	tap.evaluate(checkLookups(index, entries), "The lookups are correct after erasing regions");
+
+	index.clear();
+	tap.evaluate(index.empty(), "The index is empty after clearing it");
+}
+
+
+int main()
+{
+	tap.registerNewTests(7);
+	tap.begin();
+
+	testCounts();
+	testIndex();
+
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/runtime-info.h>
+
+#include <cstring>
+
+#include <unistd.h>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define N 256
+#define ROUNDS 40
+
+#define BLOCK_SIZE 8
+#define NUM_BLOCKS (N / BLOCK_SIZE)
+#define RELEASE_MICROSECONDS 1000
+
+
+TestAnyProtocolProducer tap;
+
+static int a[N];
+static int b[N];
+
+
+//! \brief Get the value of an integer runtime information entry, or -1 if it does not exist
+static long getRuntimeInfo(char const *name)
+{
+	for (void *it = nanos6_runtime_info_begin(); it != nanos6_runtime_info_end(); it = nanos6_runtime_info_advance(it)) {
+		nanos6_runtime_info_entry_t entry;
+		nanos6_runtime_info_get(it, &entry);
+
+		if (strcmp(entry.name, name) == 0) {
+			return entry.integer;
+		}
+	}
+	return -1;
+}
+
+
+//! Increment every element of the array once, through subtasks over blocks
+//! that are not aligned to the blocks of the previous rounds. Odd rounds use
+//! commutative accesses
+static void incrementRound(int round)
+{
+	const int blockSize = 1 << (round % 5 + 1);
+	const int offset = round % blockSize;
+	const bool commutative = (round % 2 == 1);
+
+	int start = 0;
+	int length = offset;
+	while (start < N) {
+		if (length > 0) {
+			if (commutative) {
+				#pragma oss task commutative(a[start;length])
+				for (int i = start; i < start + length; ++i) {
+					a[i]++;
+				}
+			} else {
+				#pragma oss task inout(a[start;length])
+				for (int i = start; i < start + length; ++i) {
+					a[i]++;
+				}
+			}
+		}
+
+		start += length;
+		length = (N - start < blockSize) ? N - start : blockSize;
+	}
+}
+
+
+int main()
+{
+	bool insideCorrect = true;
+	bool afterCorrect = true;
+	bool releasedCorrect = true;
+
+	tap.registerNewTests(4);
+	tap.begin();
+
+	// The fragments of the parent access are split by the subtasks of each round
+	#pragma oss task inout(a[0;N]) shared(insideCorrect)
+	{
+		for (int round = 0; round < ROUNDS; ++round) {
+			incrementRound(round);
+
+			if (round % 3 == 2) {
+				#pragma oss taskwait
+
+				for (int i = 0; i < N; ++i) {
+					if (a[i] != round + 1) {
+						insideCorrect = false;
+					}
+				}
+			}
+		}
+	}
+
+	#pragma oss task in(a[0;N]) shared(afterCorrect)
+	{
+		for (int i = 0; i < N; ++i) {
+			if (a[i] != ROUNDS) {
+				afterCorrect = false;
+			}
+		}
+	}
+	#pragma oss taskwait
+
+	tap.evaluate(insideCorrect, "The subtasks of each round saw the results of the previous ones");
+	tap.evaluate(afterCorrect, "The next task waited for all the fragments of the parent");
+
+	const long coalescedBefore = getRuntimeInfo("coalesced_fragments");
+
+	// The releaser gives back its access block by block, so the fragment of
+	// the parent that is linked to its subtask is satisfied in pieces. Each
+	// piece is coalesced with the previous ones once it becomes equivalent
+	#pragma oss task inout(b[0;N]) label("releaser")
+	{
+		for (int block = 0; block < NUM_BLOCKS; ++block) {
+			usleep(RELEASE_MICROSECONDS);
+			for (int i = block * BLOCK_SIZE; i < (block + 1) * BLOCK_SIZE; ++i) {
+				b[i]++;
+			}
+
+			#pragma oss release inout(b[block * BLOCK_SIZE;BLOCK_SIZE])
+		}
+	}
+
+	#pragma oss task weakinout(b[0;N]) shared(releasedCorrect) label("parent")
+	{
+		#pragma oss task inout(b[0;N]) shared(releasedCorrect) label("subtask")
+		{
+			for (int i = 0; i < N; ++i) {
+				if (b[i] != 1) {
+					releasedCorrect = false;
+				}
+			}
+		}
+	}
+	#pragma oss taskwait
+
+	tap.evaluate(releasedCorrect, "The subtask waited for all the released blocks");
+
+	// Only the dependency implementations that fragment the accesses report it
+	if (coalescedBefore >= 0) {
+		const long coalesced = getRuntimeInfo("coalesced_fragments") - coalescedBefore;
+		tap.emitDiagnostic("Coalesced fragments: ", coalesced);
+		tap.evaluate(coalesced > 0, "The fragments satisfied in pieces were coalesced");
+	} else {
+		tap.skip("The dependency implementation does not coalesce fragments");
+	}
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,139 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <unistd.h>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define N 16
+#define DELAY_MICROSECONDS 50000
+
+
+TestAnyProtocolProducer tap;
+
+static int M[N][N];
+
+
+static bool check(int (*matrix)[N], int rowStart, int numRows, int colStart, int numCols, int value)
+{
+	for (int i = rowStart; i < rowStart + numRows; ++i) {
+		for (int j = colStart; j < colStart + numCols; ++j) {
+			if (matrix[i][j] != value) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+int main()
+{
+	// The same array seen with rows of half the length, so its boxes have
+	// other strides than the boxes of M
+	int (*H)[N / 2] = (int (*)[N / 2]) M;
+	int noRows = 0;
+
+	bool nestedCorrect = false;
+	bool touchingCorrect = false;
+	bool strideCorrect = false;
+	bool emptyCorrect = false;
+
+	tap.registerNewTests(5);
+	tap.begin();
+
+	// A box nested in a previous one must wait for it
+	#pragma oss task out(M[0;N][0;N]) label("whole")
+	{
+		usleep(DELAY_MICROSECONDS);
+		for (int i = 0; i < N; ++i) {
+			for (int j = 0; j < N; ++j) {
+				M[i][j] = 1;
+			}
+		}
+	}
+
+	#pragma oss task inout(M[4;4][4;4]) shared(nestedCorrect) label("nested")
+	{
+		nestedCorrect = check(M, 4, 4, 4, 4, 1);
+		for (int i = 4; i < 8; ++i) {
+			for (int j = 4; j < 8; ++j) {
+				M[i][j] = 2;
+			}
+		}
+	}
+
+	// Boxes that touch each other but do not overlap, both by rows and by
+	// columns. Their rows are interleaved in memory
+	#pragma oss task inout(M[8;8][0;N / 2]) label("touching left")
+	{
+		for (int i = 8; i < N; ++i) {
+			for (int j = 0; j < N / 2; ++j) {
+				M[i][j] += 2;
+			}
+		}
+	}
+
+	#pragma oss task inout(M[8;8][N / 2;N / 2]) label("touching right")
+	{
+		for (int i = 8; i < N; ++i) {
+			for (int j = N / 2; j < N; ++j) {
+				M[i][j] += 3;
+			}
+		}
+	}
+
+	#pragma oss task in(M[8;8][0;N]) shared(touchingCorrect) label("touching check")
+	{
+		touchingCorrect = check(M, 8, 8, 0, N / 2, 3) && check(M, 8, 8, N / 2, N / 2, 4);
+	}
+	#pragma oss taskwait
+
+	// A box over the same memory with a different stride must wait for the
+	// boxes of M that overlap it
+	#pragma oss task inout(M[0;N][0;N / 4]) label("quarter")
+	{
+		usleep(DELAY_MICROSECONDS);
+		for (int i = 0; i < N; ++i) {
+			for (int j = 0; j < N / 4; ++j) {
+				M[i][j] = 5;
+			}
+		}
+	}
+
+	#pragma oss task inout(H[0;2 * N][0;N / 4]) shared(strideCorrect) label("half rows")
+	{
+		// Even rows of H are the first halves of the rows of M
+		strideCorrect = true;
+		for (int i = 0; i < 2 * N; i += 2) {
+			for (int j = 0; j < N / 4; ++j) {
+				if (H[i][j] != 5) {
+					strideCorrect = false;
+				}
+				H[i][j] = 6;
+			}
+		}
+	}
+
+	// An empty box must not make anything wait
+	#pragma oss task in(M[0;noRows][0;N]) shared(emptyCorrect) label("empty")
+	{
+		emptyCorrect = true;
+	}
+
+	#pragma oss taskwait
+
+	tap.evaluate(nestedCorrect, "The nested box waited for the enclosing box");
+	tap.evaluate(touchingCorrect, "The touching boxes were both applied");
+	tap.evaluate(strideCorrect, "The box with another stride waited for the overlapping box");
+	tap.evaluate(emptyCorrect, "The empty box was executed");
+	tap.evaluate(check(M, 0, N, 0, N / 4, 6) && check(M, 4, 4, 4, 4, 2),
+		"The final contents of the array are correct");
+	tap.end();
+
+	return 0;
+}
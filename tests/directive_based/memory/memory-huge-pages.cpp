@@ -0,0 +1,101 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/cluster.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define SIZE (4 * 1024 * 1024)
+
+
+TestAnyProtocolProducer tap;
+
+
+//! Get the flags of the mapping that contains an address, or an empty string
+static std::string getMappingFlags(void *address)
+{
+	std::ifstream smaps("/proc/self/smaps");
+	const uintptr_t target = (uintptr_t) address;
+	bool inside = false;
+	std::string line;
+
+	while (std::getline(smaps, line)) {
+		if (line.compare(0, 8, "VmFlags:") == 0) {
+			if (inside) {
+				return line.substr(8) + " ";
+			}
+			continue;
+		}
+
+		// Mapping headers start with the address range
+		uintptr_t start, end;
+		char dash;
+		std::istringstream header(line);
+		if ((header >> std::hex >> start >> dash >> end) && dash == '-') {
+			inside = (target >= start && target < end);
+		}
+	}
+	return "";
+}
+
+static bool hasFlag(std::string const &flags, char const *flag)
+{
+	return flags.find(std::string(" ") + flag + " ") != std::string::npos;
+}
+
+static long getReservedHugePages()
+{
+	std::ifstream file("/proc/sys/vm/nr_hugepages");
+	long pages = 0;
+	file >> pages;
+	return pages;
+}
+
+
+int main()
+{
+	// The mode is set by the name of the test, see select-version.sh
+	const char *override = getenv("NANOS6_CONFIG_OVERRIDE");
+	const bool explicitPages = (override != nullptr && strstr(override, "memory.huge_pages=explicit") != nullptr);
+
+	tap.registerNewTests(2);
+	tap.begin();
+
+	char *data = (char *) nanos6_lmalloc(SIZE);
+	tap.evaluate(data != nullptr, "The local memory was allocated");
+	if (data == nullptr) {
+		tap.bailOut("Cannot check the huge pages");
+		return 0;
+	}
+	memset(data, 1, SIZE);
+
+	const std::string flags = getMappingFlags(data);
+	if (flags.empty()) {
+		tap.skip("The kernel does not report the flags of the mappings");
+	} else if (!explicitPages) {
+		tap.evaluate(hasFlag(flags, "hg") && !hasFlag(flags, "ht"),
+			"The memory is advised to use transparent huge pages");
+	} else if (getReservedHugePages() == 0) {
+		tap.evaluate(hasFlag(flags, "hg") && !hasFlag(flags, "ht"),
+			"Without reserved huge pages, the memory falls back to transparent huge pages");
+	} else {
+		tap.evaluate(hasFlag(flags, "ht") || hasFlag(flags, "hg"),
+			"The memory uses either explicit or transparent huge pages");
+	}
+
+	nanos6_lfree(data, SIZE);
+	tap.end();
+
+	return 0;
+}
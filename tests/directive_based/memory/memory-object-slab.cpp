@@ -0,0 +1,200 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "TestAnyProtocolProducer.hpp"
+
+// Built with the sources of the runtime and the pool allocator in the include path
+#include "CPUObjectCache.hpp"
+#include "NUMAObjectCache.hpp"
+#include "ObjectSlab.hpp"
+
+
+#define SLAB_SIZE 4096
+#define NUM_NUMA_NODES 2
+#define SLABS_PER_NODE 20
+
+
+TestAnyProtocolProducer tap;
+
+//! The slabs handed out to the caches and their NUMA node
+static std::map<void *, size_t> liveSlabs;
+static size_t wrongSlabFrees = 0;
+
+
+// The runtime keeps this symbol hidden, so the test provides its own
+namespace ompss_debug {
+	void *getCurrentThread()
+	{
+		return nullptr;
+	}
+}
+
+
+// The caches take the slabs from the runtime allocator, so the test provides
+// its own allocator that tracks them
+size_t MemoryAllocator::_slabSize = SLAB_SIZE;
+
+void *MemoryAllocator::allocSlab(size_t numaNodeId)
+{
+	void *slab = nullptr;
+	if (posix_memalign(&slab, SLAB_SIZE, SLAB_SIZE) != 0) {
+		tap.bailOut("Cannot allocate a slab");
+		exit(1);
+	}
+	liveSlabs[slab] = numaNodeId;
+	return slab;
+}
+
+void MemoryAllocator::freeSlab(void *slab, size_t numaNodeId)
+{
+	std::map<void *, size_t>::iterator it = liveSlabs.find(slab);
+	if (it == liveSlabs.end() || it->second != numaNodeId) {
+		wrongSlabFrees++;
+		return;
+	}
+
+	liveSlabs.erase(it);
+	std::free(slab);
+}
+
+
+struct Object {
+	size_t _numaNodeId;
+	size_t _index;
+	char _payload[24];
+
+	Object(size_t numaNodeId, size_t index) :
+		_numaNodeId(numaNodeId),
+		_index(index)
+	{
+	}
+};
+
+typedef NUMAObjectCache<Object> numa_cache_t;
+typedef CPUObjectCache<Object> cpu_cache_t;
+
+
+static size_t countSlabs(size_t numaNodeId)
+{
+	size_t count = 0;
+	for (auto const &slab : liveSlabs) {
+		if (slab.second == numaNodeId) {
+			count++;
+		}
+	}
+	return count;
+}
+
+//! \brief Check that the header of the slab of each object is found by masking
+//! its address, and that the objects do not overlap the header or the next slab
+static bool checkObjects(std::vector<Object *> const &objects, size_t numaNodeId)
+{
+	std::set<Object *> unique(objects.begin(), objects.end());
+	if (unique.size() != objects.size()) {
+		tap.emitDiagnostic("An object was handed out twice");
+		return false;
+	}
+
+	for (Object *object : objects) {
+		char *slab = (char *) ObjectSlab<Object>::getSlab(object);
+		if (liveSlabs.find(slab) == liveSlabs.end()) {
+			tap.emitDiagnostic("The slab of an object was not allocated");
+			return false;
+		}
+
+		if ((char *) object < slab + sizeof(size_t) || (char *) (object + 1) > slab + SLAB_SIZE) {
+			tap.emitDiagnostic("An object is outside its slab");
+			return false;
+		}
+
+		if (ObjectSlab<Object>::getNUMANodeId(object) != numaNodeId || object->_numaNodeId != numaNodeId) {
+			tap.emitDiagnostic("An object has the wrong NUMA node");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+int main()
+{
+	tap.registerNewTests(6);
+	tap.begin();
+
+	const size_t capacity = ObjectSlab<Object>::getCapacity();
+	const size_t numObjects = SLABS_PER_NODE * capacity;
+	tap.emitDiagnostic("Objects per slab: ", capacity);
+
+	numa_cache_t numaCache(NUM_NUMA_NODES);
+	std::vector<cpu_cache_t *> cpuCaches;
+	for (size_t node = 0; node < NUM_NUMA_NODES; ++node) {
+		cpuCaches.push_back(new cpu_cache_t(&numaCache, node, NUM_NUMA_NODES));
+	}
+
+	// Allocate several slabs of objects in the CPU of each NUMA node
+	std::vector<std::vector<Object *>> objects(NUM_NUMA_NODES);
+	for (size_t node = 0; node < NUM_NUMA_NODES; ++node) {
+		for (size_t i = 0; i < numObjects; ++i) {
+			objects[node].push_back(cpuCaches[node]->newObject(node, i));
+		}
+	}
+
+	bool correct = true;
+	for (size_t node = 0; node < NUM_NUMA_NODES; ++node) {
+		correct = correct && checkObjects(objects[node], node);
+		correct = correct && (countSlabs(node) == SLABS_PER_NODE);
+	}
+	tap.evaluate(correct, "The objects fill whole slabs and their NUMA node is read from the slab header");
+
+	// Free the objects of the second node from the CPU of the first one, so
+	// they are returned to the NUMA cache of their node
+	for (Object *object : objects[1]) {
+		cpuCaches[0]->deleteObject(object);
+	}
+	tap.evaluate(countSlabs(1) < SLABS_PER_NODE / 2,
+		"The slabs freed from a CPU of another NUMA node are reclaimed");
+	tap.emitDiagnostic("Slabs of the second node after freeing: ", countSlabs(1));
+
+	// Free the objects of the first node in its own CPU
+	for (Object *object : objects[0]) {
+		cpuCaches[0]->deleteObject(object);
+	}
+	tap.evaluate(countSlabs(0) < SLABS_PER_NODE / 2,
+		"The surplus slabs of the local CPU are reclaimed");
+	tap.emitDiagnostic("Slabs of the first node after freeing: ", countSlabs(0));
+	tap.evaluate(wrongSlabFrees == 0, "The slabs are returned to the NUMA node they came from");
+
+	// The objects that are still cached are reused before allocating new slabs
+	const size_t slabsBefore = liveSlabs.size();
+	objects[0].clear();
+	for (size_t i = 0; i < capacity; ++i) {
+		objects[0].push_back(cpuCaches[0]->newObject(0, i));
+	}
+	tap.evaluate(checkObjects(objects[0], 0) && liveSlabs.size() == slabsBefore,
+		"The cached objects are reused without allocating new slabs");
+
+	for (Object *object : objects[0]) {
+		cpuCaches[0]->deleteObject(object);
+	}
+	tap.evaluate(wrongSlabFrees == 0 && liveSlabs.size() <= slabsBefore,
+		"Freeing the reused objects does not leak slabs");
+
+	for (cpu_cache_t *cpuCache : cpuCaches) {
+		delete cpuCache;
+	}
+
+	tap.end();
+
+	return 0;
+}
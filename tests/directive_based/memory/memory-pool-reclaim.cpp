@@ -0,0 +1,86 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+#include <cstdlib>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_PRODUCERS 8
+#define TASKS_PER_PRODUCER 2000
+
+TestAnyProtocolProducer tap;
+
+template <size_t SIZE>
+struct Payload {
+	long _values[SIZE];
+};
+
+static std::atomic<long> sum;
+static std::atomic<long> corrupted;
+
+// The args block of each task carries a payload, so tasks of several sizes
+// are created by the producers and disposed by the CPUs that run them
+template <size_t SIZE>
+static void consume(long value)
+{
+	Payload<SIZE> payload;
+	for (size_t i = 0; i < SIZE; ++i) {
+		payload._values[i] = value;
+	}
+
+	#pragma oss task firstprivate(payload, value)
+	{
+		for (size_t i = 0; i < SIZE; ++i) {
+			if (payload._values[i] != value) {
+				++corrupted;
+			}
+		}
+		sum += value;
+	}
+}
+
+int main()
+{
+	long expected = 0;
+	for (long p = 0; p < NUM_PRODUCERS; ++p) {
+		for (long t = 0; t < TASKS_PER_PRODUCER; ++t) {
+			expected += p * TASKS_PER_PRODUCER + t;
+		}
+	}
+
+	tap.registerNewTests(2);
+	tap.begin();
+
+	for (long p = 0; p < NUM_PRODUCERS; ++p) {
+		#pragma oss task firstprivate(p)
+		{
+			for (long t = 0; t < TASKS_PER_PRODUCER; ++t) {
+				const long value = p * TASKS_PER_PRODUCER + t;
+				switch (t % 3) {
+					case 0:
+						consume<1>(value);
+						break;
+					case 1:
+						consume<16>(value);
+						break;
+					default:
+						consume<128>(value);
+						break;
+				}
+			}
+			#pragma oss taskwait
+		}
+	}
+	#pragma oss taskwait
+
+	tap.evaluate(corrupted == 0, "The args blocks of the tasks were not corrupted");
+	tap.evaluate(sum == expected, "All the tasks were executed");
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/cluster.h>
+#include <nanos6/runtime-info.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_CHUNKS 4096
+#define CHUNK_SIZE 1024
+
+// Bytes that other runtime activity may allocate or free meanwhile
+#define TOLERANCE (NUM_CHUNKS * CHUNK_SIZE / 4)
+
+
+TestAnyProtocolProducer tap;
+
+struct MemoryStatistics {
+	long _used;
+	long _cached;
+	long _obtained;
+	bool _found;
+};
+
+
+static MemoryStatistics getStatistics()
+{
+	MemoryStatistics stats = {0, 0, 0, false};
+
+	for (void *it = nanos6_runtime_info_begin(); it != nanos6_runtime_info_end(); it = nanos6_runtime_info_advance(it)) {
+		nanos6_runtime_info_entry_t entry;
+		nanos6_runtime_info_get(it, &entry);
+
+		if (strcmp(entry.name, "memory_in_use") == 0) {
+			stats._used = entry.integer;
+			stats._found = true;
+		} else if (strcmp(entry.name, "memory_cached") == 0) {
+			stats._cached = entry.integer;
+		} else if (strcmp(entry.name, "memory_obtained") == 0) {
+			stats._obtained = entry.integer;
+		}
+	}
+	return stats;
+}
+
+static std::string toString(MemoryStatistics const &stats)
+{
+	std::ostringstream oss;
+	oss << "used " << stats._used << ", cached " << stats._cached << ", obtained " << stats._obtained;
+	return oss.str();
+}
+
+
+int main()
+{
+	const long bytes = NUM_CHUNKS * CHUNK_SIZE;
+	void *chunks[NUM_CHUNKS];
+
+	MemoryStatistics initial = getStatistics();
+	if (!initial._found) {
+		tap.registerNewTests(1);
+		tap.begin();
+		tap.skip("The memory allocator does not report statistics");
+		tap.end();
+		return 0;
+	}
+
+	tap.registerNewTests(5);
+	tap.begin();
+
+	for (int i = 0; i < NUM_CHUNKS; ++i) {
+		chunks[i] = nanos6_lmalloc(CHUNK_SIZE);
+		memset(chunks[i], 0, CHUNK_SIZE);
+	}
+	MemoryStatistics allocated = getStatistics();
+
+	tap.evaluate(allocated._used >= initial._used + bytes - TOLERANCE,
+		"The used bytes grow after the allocations: " + toString(initial) + " -> " + toString(allocated));
+	tap.evaluate(allocated._obtained >= allocated._used,
+		"The obtained bytes cover the used bytes: " + toString(allocated));
+
+	for (int i = 0; i < NUM_CHUNKS; ++i) {
+		nanos6_lfree(chunks[i], CHUNK_SIZE);
+	}
+	MemoryStatistics freed = getStatistics();
+
+	tap.evaluate(freed._used <= allocated._used - bytes + TOLERANCE,
+		"The used bytes shrink after the frees: " + toString(allocated) + " -> " + toString(freed));
+	tap.evaluate(freed._cached >= allocated._cached + bytes - TOLERANCE,
+		"The freed bytes are cached: " + toString(allocated) + " -> " + toString(freed));
+	tap.evaluate(freed._obtained >= allocated._obtained,
+		"The obtained bytes are not returned on frees: " + toString(allocated) + " -> " + toString(freed));
+
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,71 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+#include <vector>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_WAVES 50
+#define TASKS_PER_WAVE 500
+
+TestAnyProtocolProducer tap;
+
+int main()
+{
+	std::vector<long> values(TASKS_PER_WAVE, 0);
+	std::atomic<long> nonpodErrors(0);
+	long chain = 0;
+
+	tap.registerNewTests(3);
+	tap.begin();
+
+	// The blocks of the tasks of each wave are reused by the next waves,
+	// which alternate tasks of several types and layouts
+	for (int wave = 0; wave < NUM_WAVES; ++wave) {
+		for (int t = 0; t < TASKS_PER_WAVE; ++t) {
+			long *value = &values[t];
+
+			if (t % 2 == 0) {
+				#pragma oss task inout(*value)
+				*value += 1;
+			} else {
+				std::vector<long> copy(t, wave);
+
+				#pragma oss task inout(*value) inout(chain) firstprivate(copy) shared(nonpodErrors)
+				{
+					for (long element : copy) {
+						if (element != wave) {
+							++nonpodErrors;
+						}
+					}
+					*value += 1;
+					++chain;
+				}
+			}
+		}
+
+		if (wave % 2 == 0) {
+			#pragma oss taskwait
+		}
+	}
+	#pragma oss taskwait
+
+	bool correct = true;
+	for (int t = 0; t < TASKS_PER_WAVE; ++t) {
+		if (values[t] != NUM_WAVES) {
+			correct = false;
+		}
+	}
+
+	tap.evaluate(correct, "All the tasks were executed");
+	tap.evaluate(chain == NUM_WAVES * (TASKS_PER_WAVE / 2), "The dependencies were honored");
+	tap.evaluate(nonpodErrors == 0, "The args blocks were not corrupted");
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,85 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/blocking.h>
+#include <nanos6/polling.h>
+
+#include <atomic>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_SERVICES 4
+#define NUM_ROUNDS 20
+#define FINAL_CALLS 100
+#define WAIT_MICROSECONDS 20000
+
+
+TestAnyProtocolProducer tap;
+
+static std::atomic<long> calls[NUM_SERVICES];
+
+
+//! The last service unregisters itself after a fixed number of calls
+static int service(void *data)
+{
+	const long id = (long) data;
+	long current = ++calls[id];
+
+	return (id == NUM_SERVICES - 1 && current == FINAL_CALLS);
+}
+
+
+int main()
+{
+	bool called = true;
+	bool unregistered = true;
+	bool finished = true;
+
+	tap.registerNewTests(3);
+	tap.begin();
+
+	// The test runs with the polling statistics enabled, so the calls of
+	// the services are also recorded and reported at the end
+	for (int round = 0; round < NUM_ROUNDS; ++round) {
+		for (long id = 0; id < NUM_SERVICES; ++id) {
+			calls[id] = 0;
+			nanos6_register_polling_service("polling test", service, (void *) id);
+		}
+
+		nanos6_wait_for(WAIT_MICROSECONDS);
+
+		for (long id = 0; id < NUM_SERVICES - 1; ++id) {
+			nanos6_unregister_polling_service("polling test", service, (void *) id);
+			if (calls[id] == 0) {
+				called = false;
+			}
+		}
+
+		// Unregistered services are not called anymore
+		const long unregisteredCalls = calls[0];
+		nanos6_wait_for(WAIT_MICROSECONDS / 4);
+		if (calls[0] != unregisteredCalls) {
+			unregistered = false;
+		}
+
+		// Services that return true are not called again
+		while (calls[NUM_SERVICES - 1] < FINAL_CALLS) {
+			nanos6_wait_for(WAIT_MICROSECONDS / 20);
+		}
+		nanos6_wait_for(WAIT_MICROSECONDS / 10);
+		if (calls[NUM_SERVICES - 1] != FINAL_CALLS) {
+			finished = false;
+		}
+	}
+
+	tap.evaluate(called, "The registered services were called");
+	tap.evaluate(unregistered, "The unregistered services were not called anymore");
+	tap.evaluate(finished, "The services that returned true were not called anymore");
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,50 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+
+#include <unistd.h>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_WAVES 50
+#define TASKS_PER_WAVE 200
+
+
+TestAnyProtocolProducer tap;
+
+
+int main()
+{
+	std::atomic<int> executed(0);
+	bool correct = true;
+
+	tap.registerNewTests(1);
+	tap.begin();
+
+	// Waves of very short tasks separated by pauses, so that the CPUs keep
+	// switching between running tasks, spinning and being idle
+	for (int wave = 0; wave < NUM_WAVES; ++wave) {
+		for (int t = 0; t < TASKS_PER_WAVE; ++t) {
+			#pragma oss task shared(executed)
+			executed++;
+		}
+		#pragma oss taskwait
+
+		if (executed != (wave + 1) * TASKS_PER_WAVE) {
+			correct = false;
+		}
+
+		// Longer than the maximum spinning time, so the CPUs become idle
+		usleep((wave % 4) * 500);
+	}
+
+	tap.evaluate(correct, "All the tasks of each wave were executed");
+	tap.end();
+
+	return 0;
+}
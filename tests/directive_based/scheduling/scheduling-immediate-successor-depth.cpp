@@ -0,0 +1,58 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+
+#include <unistd.h>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_ROUNDS 20
+#define NUM_READERS 64
+#define DELAY_MICROSECONDS 1000
+
+
+TestAnyProtocolProducer tap;
+
+
+int main()
+{
+	std::atomic<int> stale(0);
+	std::atomic<int> executed(0);
+	int value = 0;
+
+	tap.registerNewTests(2);
+	tap.begin();
+
+	// The test runs with several immediate successors per CPU. Each writer
+	// releases more readers than a CPU keeps, so the oldest ones are passed
+	// to the CPUs that share a cache or to the ready queue
+	for (int round = 0; round < NUM_ROUNDS; ++round) {
+		#pragma oss task inout(value)
+		{
+			usleep(DELAY_MICROSECONDS);
+			value++;
+		}
+
+		for (int r = 0; r < NUM_READERS; ++r) {
+			#pragma oss task in(value) firstprivate(round) shared(stale, executed)
+			{
+				if (value != round + 1) {
+					stale++;
+				}
+				executed++;
+			}
+		}
+	}
+	#pragma oss taskwait
+
+	tap.evaluate(stale == 0, "The successors ran after their predecessor and before the next writer");
+	tap.evaluate(executed == NUM_ROUNDS * NUM_READERS, "All the successors were executed");
+	tap.end();
+
+	return 0;
+}
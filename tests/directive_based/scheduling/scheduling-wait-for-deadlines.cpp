@@ -0,0 +1,57 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/blocking.h>
+
+#include <atomic>
+#include <chrono>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_TIMEOUTS 8
+#define TASKS_PER_TIMEOUT 16
+
+
+TestAnyProtocolProducer tap;
+
+// Timeouts that fall in different levels of the deadline queue, from less
+// than a tick to beyond the first levels
+static const uint64_t timeouts[NUM_TIMEOUTS] = { 1, 10, 100, 900, 5000, 40000, 150000, 300000 };
+
+static std::atomic<int> early(0);
+static std::atomic<int> executed(0);
+
+
+int main()
+{
+	tap.registerNewTests(2);
+	tap.begin();
+
+	for (int t = 0; t < NUM_TIMEOUTS * TASKS_PER_TIMEOUT; ++t) {
+		const uint64_t timeout = timeouts[t % NUM_TIMEOUTS];
+
+		#pragma oss task firstprivate(timeout)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			nanos6_wait_for(timeout);
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+			if (elapsed < timeout) {
+				early++;
+			}
+			executed++;
+		}
+	}
+	#pragma oss taskwait
+
+	tap.evaluate(early == 0, "No task was resumed before its deadline");
+	tap.evaluate(executed == NUM_TIMEOUTS * TASKS_PER_TIMEOUT, "All the waiting tasks were resumed");
+	tap.end();
+
+	return 0;
+}
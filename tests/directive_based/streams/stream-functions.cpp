@@ -0,0 +1,151 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/library-mode.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include <unistd.h>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+// More functions than the lock-free queue of an executor holds, so that
+// some of them go through its overflow queue
+#define NUM_FUNCTIONS 3000
+#define STREAM_ID 7
+
+// One of each SPAWN_PERIOD functions spawns tasks
+#define SPAWN_PERIOD 100
+#define TASKS_PER_FUNCTION 4
+#define TASK_MICROSECONDS 1000
+
+#define TIMEOUT_MICROSECONDS 60000000
+
+
+TestAnyProtocolProducer tap;
+
+//! Set once all the functions have been added to the stream
+static std::atomic<bool> allAdded(false);
+
+//! The functions in the order they were executed
+static int order[NUM_FUNCTIONS];
+static std::atomic<int> numExecuted(0);
+
+//! The number of finished tasks of each function
+static std::atomic<int> finishedTasks[NUM_FUNCTIONS];
+
+//! The number of times that the callback of each function was called
+static std::atomic<int> callbackCalls[NUM_FUNCTIONS];
+static std::atomic<int> numCallbacks(0);
+
+static std::atomic<bool> callbacksAfterTasks(true);
+static std::atomic<bool> independentCallbacks(false);
+
+
+static bool spawnsTasks(int function)
+{
+	return (function % SPAWN_PERIOD == 0);
+}
+
+//! \brief Wait without holding the CPU until a condition holds or the timeout expires
+template <typename ConditionType>
+static void waitUntil(ConditionType condition)
+{
+	uint64_t waited = 0;
+	while (!condition() && waited < TIMEOUT_MICROSECONDS) {
+		waited += nanos6_wait_for(1000);
+	}
+}
+
+static void streamFunction(void *args)
+{
+	const int function = (int) (intptr_t) args;
+
+	// The first function holds the executor until all the functions have
+	// been added, so they pile up in its queues
+	if (function == 0) {
+		waitUntil([]() { return allAdded.load(); });
+	}
+
+	order[numExecuted++] = function;
+
+	if (spawnsTasks(function)) {
+		for (int t = 0; t < TASKS_PER_FUNCTION; ++t) {
+			#pragma oss task firstprivate(function)
+			{
+				usleep(TASK_MICROSECONDS);
+				finishedTasks[function]++;
+			}
+		}
+	} else if (function == 1) {
+		// The callback of the previous function must not depend on the
+		// tasks of this one
+		#pragma oss task
+		{
+			waitUntil([]() { return callbackCalls[0].load() > 0; });
+			independentCallbacks = (callbackCalls[0].load() > 0);
+		}
+	}
+}
+
+static void streamCallback(void *args)
+{
+	const int function = (int) (intptr_t) args;
+
+	if (spawnsTasks(function) && finishedTasks[function].load() != TASKS_PER_FUNCTION) {
+		callbacksAfterTasks = false;
+	}
+
+	callbackCalls[function]++;
+	numCallbacks++;
+}
+
+
+int main()
+{
+	tap.registerNewTests(5);
+	tap.begin();
+
+	for (int f = 0; f < NUM_FUNCTIONS; ++f) {
+		nanos6_stream_spawn_function(
+			streamFunction, (void *) (intptr_t) f,
+			streamCallback, (void *) (intptr_t) f,
+			"stream function", STREAM_ID);
+	}
+	allAdded = true;
+
+	waitUntil([]() { return numCallbacks.load() == NUM_FUNCTIONS; });
+	if (numCallbacks.load() < NUM_FUNCTIONS) {
+		tap.bailOut("Timed out waiting for the callbacks of the stream functions");
+		return 1;
+	}
+
+	bool ordered = (numExecuted.load() == NUM_FUNCTIONS);
+	for (int f = 0; ordered && f < NUM_FUNCTIONS; ++f) {
+		ordered = (order[f] == f);
+	}
+	tap.evaluate(ordered, "The functions of the stream were executed in order");
+
+	bool calledOnce = true;
+	for (int f = 0; f < NUM_FUNCTIONS; ++f) {
+		calledOnce = calledOnce && (callbackCalls[f].load() == 1);
+	}
+	tap.evaluate(calledOnce, "The callback of each function was called once");
+	tap.evaluate(callbacksAfterTasks, "The callbacks were called after the tasks of their functions");
+	tap.evaluate(independentCallbacks, "The callbacks did not wait for the tasks of later functions");
+
+	bool allFinished = true;
+	for (int f = 0; f < NUM_FUNCTIONS; f += SPAWN_PERIOD) {
+		allFinished = allFinished && (finishedTasks[f].load() == TASKS_PER_FUNCTION);
+	}
+	tap.evaluate(allFinished, "All the tasks spawned by the functions finished");
+
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,89 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+#include <sstream>
+#include <vector>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_SIZES 7
+#define NUM_CHUNKSIZES 4
+#define REPETITIONS 5
+
+
+TestAnyProtocolProducer tap;
+
+// Iteration counts that are not multiples of the chunksizes nor of the
+// number of collaborators
+static const int sizes[NUM_SIZES] = { 1, 7, 97, 1000, 1023, 4099, 32771 };
+static const int chunksizes[NUM_CHUNKSIZES] = { 1, 3, 64, 1000 };
+
+
+static bool checkOnce(std::vector<std::atomic<int> > &counts, int size)
+{
+	bool correct = true;
+	for (int i = 0; i < size; ++i) {
+		if (counts[i] != 1) {
+			correct = false;
+		}
+		counts[i] = 0;
+	}
+	return correct;
+}
+
+
+int main()
+{
+	std::vector<std::atomic<int> > counts(sizes[NUM_SIZES - 1]);
+	for (std::atomic<int> &count : counts) {
+		count = 0;
+	}
+
+	tap.registerNewTests(NUM_SIZES * 2);
+	tap.begin();
+
+	// The taskfor schedule is set through the configuration of each test.
+	// Repeat the loops so that the adaptive schedule uses the times that
+	// it measured in the previous ones
+	for (int s = 0; s < NUM_SIZES; ++s) {
+		const int size = sizes[s];
+		bool defaultCorrect = true;
+		bool chunksizeCorrect = true;
+
+		for (int r = 0; r < REPETITIONS; ++r) {
+			#pragma oss task for shared(counts)
+			for (int i = 0; i < size; ++i) {
+				counts[i]++;
+			}
+			#pragma oss taskwait
+
+			defaultCorrect = checkOnce(counts, size) && defaultCorrect;
+
+			for (int c = 0; c < NUM_CHUNKSIZES; ++c) {
+				const int chunksize = chunksizes[c];
+
+				#pragma oss task for chunksize(chunksize) shared(counts)
+				for (int i = 0; i < size; ++i) {
+					counts[i]++;
+				}
+				#pragma oss taskwait
+
+				chunksizeCorrect = checkOnce(counts, size) && chunksizeCorrect;
+			}
+		}
+
+		std::ostringstream oss;
+		oss << "Each of the " << size << " iterations ran once";
+		tap.evaluate(defaultCorrect, oss.str() + " without chunksize");
+		tap.evaluate(chunksizeCorrect, oss.str() + " with several chunksizes");
+	}
+
+	tap.end();
+
+	return 0;
+}
@@ -0,0 +1,68 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <atomic>
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+#define NUM_CHAINS 64
+#define TASKS_PER_CHAIN 2000
+#define NUM_CREATORS 4
+
+
+TestAnyProtocolProducer tap;
+
+static long chains[NUM_CHAINS];
+static std::atomic<long> executed;
+
+
+int main()
+{
+	tap.registerNewTests(2);
+	tap.begin();
+
+	// The test runs with low limits of live accesses and ready tasks, so the
+	// creators are throttled and have to run ready tasks to make progress
+	for (int c = 0; c < NUM_CREATORS; ++c) {
+		#pragma oss task firstprivate(c)
+		{
+			for (int t = 0; t < TASKS_PER_CHAIN; ++t) {
+				for (int chain = c; chain < NUM_CHAINS; chain += NUM_CREATORS) {
+					long *element = &chains[chain];
+
+					#pragma oss task inout(*element)
+					{
+						(*element)++;
+						executed++;
+					}
+				}
+			}
+
+			// A taskloop is throttled too, although it cannot wait for
+			// its children
+			#pragma oss taskloop grainsize(1)
+			for (int t = 0; t < TASKS_PER_CHAIN; ++t) {
+				executed++;
+			}
+			#pragma oss taskwait
+		}
+	}
+	#pragma oss taskwait
+
+	bool correct = true;
+	for (int chain = 0; chain < NUM_CHAINS; ++chain) {
+		if (chains[chain] != TASKS_PER_CHAIN) {
+			correct = false;
+		}
+	}
+
+	tap.evaluate(correct, "The dependencies of the throttled tasks were honored");
+	tap.evaluate(executed == (NUM_CHAINS + NUM_CREATORS) * TASKS_PER_CHAIN, "All the throttled tasks were executed");
+	tap.end();
+
+	return 0;
+}
@@ -2,7 +2,7 @@
 
 #	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 #
-#	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+#	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
 
 # The top build directory is passed on the first parameter
 DIR=$1
@@ -21,6 +21,50 @@ if [[ "${*}" == *"fibonacci"* ]] || [[ "${*}" == *"task-for-nqueens"* ]] || [[ "
 	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},scheduler.policy=lifo"
 fi
 
+# Make the CPU pools return their free chunks as soon as possible
+if [[ "${*}" == *"memory-pool"* ]]; then
+	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},memory.pool.cpu_high_water=1K"
+fi
+
+# Run the huge page tests with the mode in their name
+for mode in transparent explicit; do
+	if [[ "${*}" == *"memory-huge-pages-${mode}"* ]]; then
+		export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},memory.huge_pages=${mode}"
+	fi
+done
+
+# Run the taskfor schedule tests with the schedule in their name
+for schedule in static dynamic guided adaptive; do
+	if [[ "${*}" == *"task-for-schedule-${schedule}"* ]]; then
+		export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},taskfor.schedule=${schedule}"
+	fi
+done
+
+# Keep several immediate successors per CPU in its specific test
+if [[ "${*}" == *"immediate-successor-depth"* ]]; then
+	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},scheduler.immediate_successor_depth=4"
+fi
+
+# Use the hybrid CPU manager policy in its specific test
+if [[ "${*}" == *"hybrid-policy"* ]]; then
+	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},cpumanager.policy=hybrid"
+fi
+
+# Report how the user mutexes were acquired in the critical tests
+if [[ "${*}" == *"critical"* ]]; then
+	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},misc.mutex_statistics=true"
+fi
+
+# Report the statistics of the polling services in their tests
+if [[ "${*}" == *"polling"* ]]; then
+	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},misc.polling_statistics=true"
+fi
+
+# Use low throttle limits in the throttle tests
+if [[ "${*}" == *"throttle"* ]]; then
+	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},throttle.enabled=true,throttle.max_accesses=1000,throttle.ready_tasks_per_cpu=4"
+fi
+
 # Enable DLB for dlb-specific tests
 if [[ "${*}" == *"dlb-"* ]]; then
 	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},dlb.enabled=true"